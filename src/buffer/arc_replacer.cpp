@@ -0,0 +1,166 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// arc_replacer.cpp
+//
+// Identification: src/buffer/arc_replacer.cpp
+//
+// Copyright (c) 2015-2022, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#include "buffer/arc_replacer.h"
+
+#include <algorithm>
+
+namespace bustub {
+
+ARCReplacer::ARCReplacer(size_t num_frames) : nodes_(num_frames), replacer_size_(num_frames) {}
+
+auto ARCReplacer::VictimList() -> ListId {
+  bool t1_ready = !t1_evictable_.empty();
+  bool t2_ready = !t2_evictable_.empty();
+  if (t1_ready && (t1_size_ > p_ || !t2_ready)) {
+    return ListId::T1;
+  }
+  return t2_ready ? ListId::T2 : ListId::None;
+}
+
+void ARCReplacer::TrimGhosts() {
+  while (b1_.Size() > 0 && t1_size_ + b1_.Size() > replacer_size_) {
+    b1_.PopBack();
+  }
+  while (t1_size_ + t2_size_ + b1_.Size() + b2_.Size() > 2 * replacer_size_) {
+    if (b2_.Size() > 0) {
+      b2_.PopBack();
+    } else if (b1_.Size() > 0) {
+      b1_.PopBack();
+    } else {
+      break;
+    }
+  }
+}
+
+auto ARCReplacer::Evict(frame_id_t *frame_id) -> bool {
+  std::lock_guard<std::mutex> lock(latch_);
+  ListId list = VictimList();
+  if (list == ListId::None) {
+    return false;
+  }
+  std::set<EvictKey> &candidates = EvictSetOf(list);
+  *frame_id = candidates.begin()->second;
+  candidates.erase(candidates.begin());
+  Node &node = nodes_[*frame_id];
+  if (list == ListId::T1) {
+    t1_size_--;
+    if (node.page_id_ != INVALID_PAGE_ID) {
+      b1_.Push(node.page_id_);
+    }
+  } else {
+    t2_size_--;
+    if (node.page_id_ != INVALID_PAGE_ID) {
+      b2_.Push(node.page_id_);
+    }
+  }
+  node = Node();
+  TrimGhosts();
+  return true;
+}
+
+void ARCReplacer::RecordAccess(frame_id_t frame_id, [[maybe_unused]] AccessType access_type, page_id_t page_id) {
+  std::lock_guard<std::mutex> lock(latch_);
+  BUSTUB_ASSERT(frame_id >= 0 && static_cast<size_t>(frame_id) < replacer_size_, "invalid frame id");
+  Node &node = nodes_[frame_id];
+  if (node.evictable_) {
+    EvictSetOf(node.list_).erase({node.last_access_, frame_id});
+  }
+  if (node.list_ == ListId::T1) {
+    // second hit since the page came in: it is frequent now
+    node.list_ = ListId::T2;
+    t1_size_--;
+    t2_size_++;
+  } else if (node.list_ == ListId::None) {
+    if (page_id != INVALID_PAGE_ID && b1_.Contains(page_id)) {
+      // T1 evicted this page too early, let T1 grow
+      p_ = std::min(replacer_size_, p_ + std::max<size_t>(b2_.Size() / b1_.Size(), 1));
+      b1_.Erase(page_id);
+      node.list_ = ListId::T2;
+      t2_size_++;
+    } else if (page_id != INVALID_PAGE_ID && b2_.Contains(page_id)) {
+      // T2 evicted this page too early, let T2 grow
+      p_ -= std::min(p_, std::max<size_t>(b1_.Size() / b2_.Size(), 1));
+      b2_.Erase(page_id);
+      node.list_ = ListId::T2;
+      t2_size_++;
+    } else {
+      node.list_ = ListId::T1;
+      t1_size_++;
+    }
+    node.page_id_ = page_id;
+    TrimGhosts();
+  }
+  node.last_access_ = ++current_timestamp_;
+  if (node.evictable_) {
+    EvictSetOf(node.list_).insert({node.last_access_, frame_id});
+  }
+}
+
+void ARCReplacer::SetEvictable(frame_id_t frame_id, bool set_evictable) {
+  std::lock_guard<std::mutex> lock(latch_);
+  BUSTUB_ASSERT(frame_id >= 0 && static_cast<size_t>(frame_id) < replacer_size_, "invalid frame id");
+  Node &node = nodes_[frame_id];
+  if (node.list_ == ListId::None || node.evictable_ == set_evictable) {
+    return;
+  }
+  node.evictable_ = set_evictable;
+  if (set_evictable) {
+    EvictSetOf(node.list_).insert({node.last_access_, frame_id});
+  } else {
+    EvictSetOf(node.list_).erase({node.last_access_, frame_id});
+  }
+}
+
+void ARCReplacer::Remove(frame_id_t frame_id) {
+  std::lock_guard<std::mutex> lock(latch_);
+  BUSTUB_ASSERT(frame_id >= 0 && static_cast<size_t>(frame_id) < replacer_size_, "invalid frame id");
+  Node &node = nodes_[frame_id];
+  if (node.list_ == ListId::None) {
+    return;
+  }
+  BUSTUB_ASSERT(node.evictable_, "cannot remove a non-evictable frame");
+  EvictSetOf(node.list_).erase({node.last_access_, frame_id});
+  if (node.list_ == ListId::T1) {
+    t1_size_--;
+  } else {
+    t2_size_--;
+  }
+  node = Node();
+}
+
+auto ARCReplacer::Size() -> size_t {
+  std::lock_guard<std::mutex> lock(latch_);
+  return t1_evictable_.size() + t2_evictable_.size();
+}
+
+auto ARCReplacer::EvictionCandidates(size_t max_num) -> std::vector<frame_id_t> {
+  std::lock_guard<std::mutex> lock(latch_);
+  std::vector<frame_id_t> candidates;
+  // the list the next victim comes from first, then the other one
+  ListId first = VictimList() == ListId::T2 ? ListId::T2 : ListId::T1;
+  ListId second = first == ListId::T1 ? ListId::T2 : ListId::T1;
+  for (ListId list : {first, second}) {
+    const std::set<EvictKey> &frames = EvictSetOf(list);
+    for (auto it = frames.begin(); it != frames.end() && candidates.size() < max_num; ++it) {
+      candidates.push_back(it->second);
+    }
+  }
+  return candidates;
+}
+
+auto ARCReplacer::TargetT1Size() -> size_t {
+  std::lock_guard<std::mutex> lock(latch_);
+  return p_;
+}
+
+}  // namespace bustub
@@ -12,6 +12,9 @@
 
 #include "buffer/buffer_pool_manager.h"
 
+#include <algorithm>
+#include <chrono>  // NOLINT
+
 #include "common/exception.h"
 #include "common/macros.h"
 #include "storage/page/page_guard.h"
@@ -19,237 +22,915 @@
 namespace bustub {
 
 BufferPoolManager::BufferPoolManager(size_t pool_size, DiskManager *disk_manager, size_t replacer_k,
-                                     LogManager *log_manager)
-    : pool_size_(pool_size), disk_manager_(disk_manager), log_manager_(log_manager) {
+                                     LogManager *log_manager, size_t num_instances, ReplacerPolicy replacer_policy,
+                                     size_t max_pool_size)
+    : pool_size_(pool_size),
+      max_pool_size_(std::max(pool_size, max_pool_size)),
+      num_instances_(num_instances),
+      scan_ring_size_((SCAN_RING_SIZE + num_instances - 1) / num_instances),
+      page_size_(disk_manager->GetPageSize()),
+      disk_manager_(disk_manager),
+      log_manager_(log_manager),
+      disk_scheduler_(std::make_unique<DiskScheduler>(disk_manager)) {
   // TODO(students): remove this line after you have implemented the buffer pool manager
 //   throw NotImplementedException(
 //       "BufferPoolManager is not implemented yet. If you have finished implementing BPM, please remove the throw "
 //       "exception line in `buffer_pool_manager.cpp`.");
+  BUSTUB_ENSURE(num_instances_ > 0 && num_instances_ <= pool_size_, "invalid number of buffer pool instances");
 
   // we allocate a consecutive memory space for the buffer pool
-  pages_ = new Page[pool_size_];
-  replacer_ = std::make_unique<LRUKReplacer>(pool_size, replacer_k);
+  // 按最大容量预留，resize不移动任何frame，无锁的读者不受影响
+  pages_ = new Page[max_pool_size_];
+  arena_ = std::make_unique<FrameArena>(max_pool_size_, enable_huge_pages, page_size_);
+  for (size_t i = 0; i < max_pool_size_; ++i) {
+    pages_[i].data_ = arena_->GetFrame(i);
+    pages_[i].size_ = page_size_;
+    if (i >= pool_size_) {
+        // 未启用的frame保持被占住的状态
+        pages_[i].pin_count_ = -1;
+    }
+  }
+
+  for (size_t i = 0; i < num_instances_; ++i) {
+    auto instance = std::make_unique<BufferPoolInstance>();
+    instance->index_ = i;
+    // 第i个分区拥有frame i, i + n, i + 2n, ...
+    size_t num_frames = (max_pool_size_ - i + num_instances_ - 1) / num_instances_;
+    instance->replacer_ = MakeReplacer(replacer_policy, num_frames, replacer_k);
+    // 脏页写回期间，一个frame同时被新旧两个page映射
+    instance->page_table_ = std::make_unique<PageTable>(2 * num_frames);
+    for (auto &slot : instance->access_buffer_) {
+        slot = -1;
+    }
+    instances_.push_back(std::move(instance));
+  }
 
   // Initially, every page is in the free list.
   for (size_t i = 0; i < pool_size_; ++i) {
-    free_list_.emplace_back(static_cast<int>(i));
+    instances_[i % num_instances_]->free_list_.emplace_back(static_cast<int>(i));
   }
+
+  read_ahead_thread_ = new std::thread(&BufferPoolManager::RunReadAhead, this);
 }
 
-BufferPoolManager::~BufferPoolManager() { delete[] pages_; }
+BufferPoolManager::~BufferPoolManager() {
+    read_ahead_queue_.Put(std::nullopt);
+    read_ahead_thread_->join();
+    delete read_ahead_thread_;
 
-auto BufferPoolManager::NewPage(page_id_t *page_id) -> Page * {
-    frame_id_t frame_id = -1;
-    *page_id = INVALID_PAGE_ID;
-    std::lock_guard<std::mutex> lock(latch_);
+    enable_background_flush_ = false;
+    if (background_flush_thread_ != nullptr) {
+        background_flush_cv_.notify_all();
+        background_flush_thread_->join();
+        delete background_flush_thread_;
+    }
+    delete[] pages_;
+}
 
-    if (NewFrameUnlocked(frame_id) == nullptr) return nullptr;
+void BufferPoolManager::StartBackgroundFlush(size_t clean_reserve) {
+    BUSTUB_ENSURE(background_flush_thread_ == nullptr, "background flush is already started");
+    // 每个分区各自保留一份
+    clean_reserve_ = (clean_reserve + num_instances_ - 1) / num_instances_;
+    enable_background_flush_ = true;
+    background_flush_thread_ = new std::thread(&BufferPoolManager::RunBackgroundFlush, this);
+}
 
-    replacer_->RecordAccess(frame_id);  // 确保frame存在于replacer中，并添加一条history
-    replacer_->SetEvictable(frame_id, false);
+void BufferPoolManager::RunReadAhead() {
+    while (auto first_page_id = read_ahead_queue_.Get()) {
+        ReadAhead(*first_page_id);
+    }
+}
 
-    Page *page = pages_ + frame_id;
+void BufferPoolManager::ReadAhead(page_id_t first_page_id) {
+    // 只预读已经分配过的page
+    page_id_t end_page_id = std::min<page_id_t>(first_page_id + READ_AHEAD_PAGES, disk_manager_->GetNumPages());
+    std::vector<std::pair<frame_id_t, std::future<bool>>> reads;
+    for (page_id_t page_id = first_page_id; page_id < end_page_id; ++page_id) {
+        BufferPoolInstance &instance = GetInstance(page_id);
+        std::unique_lock<std::mutex> lock(instance.latch_);
+        if (instance.page_table_->Find(page_id) != -1) {
+            // 已经在内存中，或者正在被读入
+            continue;
+        }
+        frame_id_t frame_id = -1;
+        Page *page = ReserveFrame(instance, lock, page_id, frame_id, AccessType::Scan);
+        if (page == nullptr) {
+            // 该分区的frame都被pin住了，不为预读等待
+            continue;
+        }
+        lock.unlock();
+        // 先把整个窗口的读请求都发出去，再统一等待
+        reads.emplace_back(frame_id, ScheduleIo(false, page_id, page->GetData()));
+    }
 
-    page->page_id_ = AllocatePage();
-    page->pin_count_ = 1;
-    page->is_dirty_ = false;
+    for (auto &[frame_id, future] : reads) {
+        future.get();
+        Page &page = pages_[frame_id];
+        BufferPoolInstance &instance = GetInstance(page.GetPageId());
+        {
+            std::lock_guard<std::mutex> lock(instance.latch_);
+            page.read_ahead_ = true;
+            page.version_.fetch_add(1, std::memory_order_release);
+            page.io_in_progress_ = false;
+            page.io_cv_.notify_all();
+        }
+        // 预读的页不保持pin，和普通的页一样参与替换
+        UnpinFrame(instance, frame_id);
+    }
+}
 
-    *page_id = page->page_id_;
+void BufferPoolManager::RunBackgroundFlush() {
+    while (enable_background_flush_) {
+        {
+            std::unique_lock<std::mutex> lock(background_flush_latch_);
+            background_flush_cv_.wait_for(lock, background_flush_interval);
+        }
+        for (auto &instance : instances_) {
+            FlushColdPages(*instance);
+        }
+    }
+}
 
-    page_table_.insert(std::make_pair(*page_id, frame_id));
+void BufferPoolManager::FlushColdPages(BufferPoolInstance &instance) {
+    std::vector<frame_id_t> frames;
+    {
+        std::lock_guard<std::mutex> lock(instance.latch_);
+        if (instance.free_list_.size() >= clean_reserve_) {
+            return;
+        }
+        DrainAccesses(instance);
+        for (frame_id_t local_frame_id :
+             instance.replacer_->EvictionCandidates(clean_reserve_ - instance.free_list_.size())) {
+            frame_id_t frame_id = ToGlobalFrameId(instance, local_frame_id);
+            Page &page = pages_[frame_id];
+            // replacer中的可驱除标记可能落后于无锁的pin，被pin住的frame跳过
+            if (page.GetPinCount() != 0 || page.io_in_progress_ || !page.is_dirty_) {
+                continue;
+            }
+            // 可驱除的frame一般没有人持有它的latch；拿不到读latch就跳过，避免和持有latch的线程死锁
+            if (!page.TryRLatch()) {
+                continue;
+            }
+            // pin住frame防止写回期间被驱除，写回期间对该页的修改会在unpin时重新标记为脏页
+            page.pin_count_++;
+            instance.replacer_->SetEvictable(local_frame_id, false);
+            page.is_dirty_ = false;
+            frames.push_back(frame_id);
+        }
+    }
+    if (frames.empty()) {
+        return;
+    }
+
+    std::vector<std::future<bool>> futures;
+    futures.reserve(frames.size());
+    for (frame_id_t frame_id : frames) {
+        futures.push_back(ScheduleIo(true, pages_[frame_id].GetPageId(), pages_[frame_id].GetData()));
+    }
+    for (size_t i = 0; i < frames.size(); ++i) {
+        futures[i].get();
+        pages_[frames[i]].RUnlatch();
+        UnpinFrame(instance, frames[i]);
+    }
+}
+
+auto BufferPoolManager::NewPage(page_id_t *page_id, page_id_t segment) -> Page * {
+    frame_id_t frame_id = -1;
+    *page_id = INVALID_PAGE_ID;
+
+    // 先分配page id，再由page id决定由哪个分区缓存
+    page_id_t new_page_id = AllocatePage(segment);
+    BufferPoolInstance &instance = GetInstance(new_page_id);
+    std::unique_lock<std::mutex> lock(instance.latch_);
+
+    // 预读可能已经把刚分配的page id读进了内存，读到的内容没有意义，直接复用该frame
+    frame_id = FindFrame(lock, instance, new_page_id);
+    if (frame_id != -1) {
+        Page *page = pages_ + frame_id;
+        instance.replacer_->RecordAccess(ToLocalFrameId(frame_id), AccessType::Unknown, new_page_id);
+        instance.replacer_->SetEvictable(ToLocalFrameId(frame_id), false);
+        page->pin_count_++;
+        // page id可能属于一个已释放的页，磁盘上还是它的旧内容，清零的新页必须写回
+        page->is_dirty_ = true;
+        page->read_ahead_ = false;
+        page->version_.fetch_add(1, std::memory_order_acq_rel);
+        page->ResetMemory();
+        page->version_.fetch_add(1, std::memory_order_release);
+        LeaveScanRing(instance, frame_id);
+        *page_id = new_page_id;
+        return page;
+    }
+
+    Page *page = ReserveFrame(instance, lock, new_page_id, frame_id);
+    if (page == nullptr) {
+        // 分区已满，归还刚分配的page id，之后的分配会复用它
+        DeallocatePage(new_page_id);
+        return nullptr;
+    }
+
+    // 新页无需读盘，frame已清零；磁盘上可能还是已释放的页的旧内容，新页必须写回
+    page->is_dirty_ = true;
+    page->version_.fetch_add(1, std::memory_order_release);
+    page->io_in_progress_ = false;
+    page->io_cv_.notify_all();
+
+    *page_id = new_page_id;
     return page;
 }
 
-auto BufferPoolManager::NewFrameUnlocked(frame_id_t &frame_id) -> Page *{
+auto BufferPoolManager::FindFrame(std::unique_lock<std::mutex> &lock, BufferPoolInstance &instance,
+                                  page_id_t page_id) -> frame_id_t {
+    while (true) {
+        frame_id_t frame_id = instance.page_table_->Find(page_id);
+        if (frame_id == -1) {
+            return -1;
+        }
+        Page &page = pages_[frame_id];
+        if (!page.io_in_progress_) {
+            BUSTUB_ASSERT(page_id == page.GetPageId(), "");
+            return frame_id;
+        }
+        // frame正在读盘或写回，只等待该frame，完成后重新查找
+        page.io_cv_.wait(lock);
+    }
+}
+
+auto BufferPoolManager::ReserveFrame(BufferPoolInstance &instance, std::unique_lock<std::mutex> &lock,
+                                     page_id_t page_id, frame_id_t &frame_id, AccessType access_type) -> Page * {
     frame_id = -1;  // 初始化为无效
-    if (!free_list_.empty()) {
+    DrainAccesses(instance);
+    if (!instance.free_list_.empty()) {
         // 优先找free_list
-        frame_id = free_list_.front();
-        free_list_.pop_front();
-        // BUSTUB_ASSERT(frame_id != -1, "");
+        frame_id = instance.free_list_.front();
+        instance.free_list_.pop_front();
+        // 空闲的frame不在page table中，只可能被拿着旧映射的无锁读者短暂pin住，它们校验失败后马上会unpin
+        while (!TryClaimFrame(pages_[frame_id])) {
+            std::this_thread::yield();
+        }
+    } else if (access_type == AccessType::Scan && (frame_id = RecycleScanFrame(instance)) != -1) {
+        // 扫描的环已满，复用环里最旧的frame，不去驱除其他页
     } else {
         // 最坏情况，去驱除内存页
-        bool ret = replacer_->Evict(&frame_id);
-        if (ret == true) {    // 驱除成功
-            // BUSTUB_ASSERT(frame_id != -1, "");
-            BUSTUB_ASSERT(pages_[frame_id].GetPinCount() == 0, "");
-
-            if (pages_[frame_id].IsDirty()) {
-                // 脏页写回磁盘
-                disk_manager_->WritePage(pages_[frame_id].GetPageId(), pages_[frame_id].GetData());
+        while (true) {
+            frame_id_t local_frame_id = -1;
+            if (!instance.replacer_->Evict(&local_frame_id)) {
+                // 没有多余或者可驱除的frame。
+                return nullptr;
+            }
+            frame_id = ToGlobalFrameId(instance, local_frame_id);
+            if (TryClaimFrame(pages_[frame_id])) {
+                break;
             }
-            pages_[frame_id].ResetMemory();
-            page_table_.erase(pages_[frame_id].GetPageId());    // 在page_table_上清除pageid -> frameid
+            // frame已经被无锁的快速路径pin住，replacer中的可驱除标记过时了，把它重新交给replacer追踪
+            instance.replacer_->RecordAccess(local_frame_id, AccessType::Unknown, pages_[frame_id].GetPageId());
+            instance.replacer_->SetEvictable(local_frame_id, false);
+            if (pages_[frame_id].GetPinCount() == 0) {
+                // 期间pin已经归零，unpin时replacer中还没有该frame
+                instance.replacer_->SetEvictable(local_frame_id, true);
+            }
+        }
+    }
 
-            pages_[frame_id].page_id_ = INVALID_PAGE_ID;
-            pages_[frame_id].pin_count_ = 0;
-            pages_[frame_id].is_dirty_ = false;
+    BUSTUB_ASSERT(frame_id != -1, "");
+    BUSTUB_ASSERT(frame_id % num_instances_ == instance.index_, "");    // frame属于该分区
 
-        } else {
-            // 没有多余或者可驱除的frame。
-            return nullptr;
+    Page *page = pages_ + frame_id;
+    BUSTUB_ASSERT(page->GetPinCount() == -1 && !page->io_in_progress_, "");
+
+    page_id_t victim_page_id = page->page_id_;
+    bool victim_dirty = page->is_dirty_;
+    if (victim_page_id != INVALID_PAGE_ID) {
+        instance.evictions_.fetch_add(1, std::memory_order_relaxed);
+        if (victim_dirty) {
+            instance.dirty_evictions_.fetch_add(1, std::memory_order_relaxed);
         }
     }
+    if (victim_page_id != INVALID_PAGE_ID && !victim_dirty) {
+        instance.page_table_->Erase(victim_page_id);    // 在page_table_上清除pageid -> frameid
+    }
 
-    BUSTUB_ASSERT(frame_id != -1, "");
+    // 占住frame：I/O完成前，所有访问该frame的线程都会在io_cv_上等待
+    page->io_in_progress_ = true;
+    page->page_id_ = page_id;
+    page->is_dirty_ = false;
+    page->read_ahead_ = false;
+    // 最后才允许pin，无锁pin住该frame的线程一定能看到新的page id和I/O标记
+    page->pin_count_ = 1;
+
+    instance.replacer_->RecordAccess(ToLocalFrameId(frame_id), access_type, page_id);  // 确保frame存在于replacer中，并添加一条history
+    instance.replacer_->SetEvictable(ToLocalFrameId(frame_id), false);
+
+    // 扫描读入的页放在环的末尾，其他页不进入环
+    LeaveScanRing(instance, frame_id);
+    if (access_type == AccessType::Scan) {
+        instance.scan_ring_.push_back(frame_id);
+        page->in_scan_ring_ = true;
+    }
 
-    BUSTUB_ASSERT(pages_[frame_id].page_id_ == INVALID_PAGE_ID, "");    // 没被占用
-    return pages_ + frame_id;
+    // 建立page_id -> frame_id的映射，之后并发访问该page的线程会等待本次I/O，而不会重复读盘
+    instance.page_table_->Insert(page_id, frame_id);
+
+    if (victim_page_id != INVALID_PAGE_ID) {
+        lock.unlock();
+        if (victim_dirty) {
+            if (enable_background_flush_) {
+                // 后台没来得及写回，唤醒它补充干净的frame
+                background_flush_cv_.notify_one();
+            }
+            // 脏页写回磁盘，写回期间旧的映射仍指向该frame，访问旧page的线程会等待写回完成
+            ScheduleIo(true, victim_page_id, page->GetData()).get();
+        }
+        page->ResetMemory();
+        lock.lock();
+
+        if (victim_dirty) {
+            instance.page_table_->Erase(victim_page_id);
+            page->io_cv_.notify_all();
+        }
+    }
+    return page;
 }
 
-auto BufferPoolManager::FetchPage(page_id_t page_id, [[maybe_unused]] AccessType access_type) -> Page * {
-    std::lock_guard<std::mutex> lock(latch_);
-    auto target = page_table_.find(page_id);
-    frame_id_t frame_id = -1;
-    if (target != page_table_.end()) {
-        // page在内存中
-        frame_id = target->second;
+auto BufferPoolManager::RecycleScanFrame(BufferPoolInstance &instance) -> frame_id_t {
+    if (instance.scan_ring_.size() < scan_ring_size_) {
+        return -1;
+    }
+    for (auto it = instance.scan_ring_.begin(); it != instance.scan_ring_.end(); ++it) {
+        frame_id_t frame_id = *it;
+        Page &page = pages_[frame_id];
+        if (!page.io_in_progress_ && TryClaimFrame(page)) {
+            instance.scan_ring_.erase(it);
+            page.in_scan_ring_ = false;
+            // 未被pin的frame一定是可驱除的，直接停止在replacer中追踪它；replacer中的标记可能还没跟上无锁的unpin
+            instance.replacer_->SetEvictable(ToLocalFrameId(frame_id), true);
+            instance.replacer_->Remove(ToLocalFrameId(frame_id));
+            return frame_id;
+        }
+    }
+    return -1;
+}
 
-        BUSTUB_ASSERT(page_id == pages_[frame_id].GetPageId(), "");
-        replacer_->RecordAccess(frame_id);  // 确保frame存在于replacer中，并添加一条history
-        replacer_->SetEvictable(frame_id, false);
-        pages_[frame_id].pin_count_++;  // 引用计数加一
+void BufferPoolManager::LeaveScanRing(BufferPoolInstance &instance, frame_id_t frame_id) {
+    if (!pages_[frame_id].in_scan_ring_) {
+        return;
+    }
+    pages_[frame_id].in_scan_ring_ = false;
+    instance.scan_ring_.erase(std::find(instance.scan_ring_.begin(), instance.scan_ring_.end(), frame_id));
+}
 
-        //return pages_ + frame_id;
-    } else {
-        // page不在内存中
-        if (NewFrameUnlocked(frame_id) == nullptr) return nullptr;   // 缓存满
+auto BufferPoolManager::PinResidentPage(BufferPoolInstance &instance, page_id_t page_id, AccessType access_type)
+    -> Page * {
+    frame_id_t frame_id = instance.page_table_->Find(page_id);
+    if (frame_id == -1) {
+        return nullptr;
+    }
+    Page &page = pages_[frame_id];
+    if (!TryPin(page)) {
+        // frame正在被驱除
+        return nullptr;
+    }
+    // pin住之后frame不会再换给其他page，确认它装的是page_id并且数据已经就绪；
+    // 扫描环和预读的记录需要分区的锁，交给慢速路径处理
+    bool needs_latch = access_type == AccessType::Scan ? page.read_ahead_.load() : page.in_scan_ring_.load();
+    if (page.GetPageId() != page_id || page.io_in_progress_ || needs_latch) {
+        UnpinFrame(instance, frame_id);
+        return nullptr;
+    }
 
-        replacer_->RecordAccess(frame_id);  // 确保frame存在于replacer中，并添加一条history
-        replacer_->SetEvictable(frame_id, false);
+    size_t slot = instance.access_write_.fetch_add(1) % BufferPoolInstance::ACCESS_BUFFER_SIZE;
+    instance.access_buffer_[slot] = frame_id;
+    return &page;
+}
 
+auto BufferPoolManager::TryPin(Page &page) -> bool {
+    int pin_count = page.pin_count_.load();
+    while (pin_count >= 0) {
+        if (page.pin_count_.compare_exchange_weak(pin_count, pin_count + 1)) {
+            return true;
+        }
+    }
+    return false;
+}
 
-        // 从磁盘读数据到frame上
-        disk_manager_->ReadPage(page_id, pages_[frame_id].GetData());
+auto BufferPoolManager::TryClaimFrame(Page &page) -> bool {
+    int expected = 0;
+    if (!page.pin_count_.compare_exchange_strong(expected, -1)) {
+        return false;
+    }
+    // 版本号变为奇数，直到frame装入新的page，乐观读者的校验都会失败
+    page.version_.fetch_add(1, std::memory_order_acq_rel);
+    return true;
+}
 
-        // 初始化frame相关的参数
-        pages_[frame_id].page_id_ = page_id;
-        pages_[frame_id].pin_count_ = 1;
-        pages_[frame_id].is_dirty_ = false;
+auto BufferPoolManager::UnpinFrame(BufferPoolInstance &instance, frame_id_t frame_id) -> bool {
+    Page &page = pages_[frame_id];
+    int pin_count = page.pin_count_.load();
+    do {
+        if (pin_count <= 0) {
+            return false;
+        }
+    } while (!page.pin_count_.compare_exchange_weak(pin_count, pin_count - 1));
 
+    if (pin_count == 1) {
+        // 最后一个pin，replacer自己有锁，不需要分区的锁
+        instance.replacer_->SetEvictable(ToLocalFrameId(frame_id), true);
+    }
+    return true;
+}
 
-        // 建立page_id -> frame_id的映射
-        page_table_.insert(std::make_pair(page_id, frame_id));
+void BufferPoolManager::DrainAccesses(BufferPoolInstance &instance) {
+    size_t end = instance.access_write_.load();
+    if (end - instance.access_read_ > BufferPoolInstance::ACCESS_BUFFER_SIZE) {
+        // 缓冲区被覆盖过，只剩最近的访问
+        instance.access_read_ = end - BufferPoolInstance::ACCESS_BUFFER_SIZE;
+    }
+    for (; instance.access_read_ < end; ++instance.access_read_) {
+        size_t slot = instance.access_read_ % BufferPoolInstance::ACCESS_BUFFER_SIZE;
+        frame_id_t frame_id = instance.access_buffer_[slot].exchange(-1);
+        // 空闲的frame不能进入replacer，否则可能被驱除两次
+        if (frame_id == -1) {
+            continue;
+        }
+        page_id_t page_id = pages_[frame_id].GetPageId();
+        if (page_id != INVALID_PAGE_ID) {
+            instance.replacer_->RecordAccess(ToLocalFrameId(frame_id), AccessType::Unknown, page_id);
+        }
+    }
+}
 
+auto BufferPoolManager::FetchPage(page_id_t page_id, AccessType access_type) -> Page * {
+    if (page_id < 0) {
+        return nullptr;
     }
-    return pages_ + frame_id;
+    BufferPoolInstance &instance = GetInstance(page_id);
+    // 快速路径：page在内存中时不加锁
+    auto access_idx = static_cast<size_t>(access_type);
+    if (Page *page = PinResidentPage(instance, page_id, access_type); page != nullptr) {
+        instance.hits_[access_idx].fetch_add(1, std::memory_order_relaxed);
+        return page;
+    }
+
+    auto start = std::chrono::steady_clock::now();
+    std::unique_lock<std::mutex> lock(instance.latch_);
+    DrainAccesses(instance);
+    frame_id_t frame_id = FindFrame(lock, instance, page_id);
+    if (frame_id != -1) {
+        // page在内存中
+        PinFrame(instance, frame_id, access_type);
+        instance.hits_[access_idx].fetch_add(1, std::memory_order_relaxed);
+        return pages_ + frame_id;
+    }
+
+    // page不在内存中
+    Page *page = ReserveFrame(instance, lock, page_id, frame_id, access_type);
+    if (page == nullptr) return nullptr;   // 缓存满
+    if (access_type == AccessType::Scan) {
+        // 顺序扫描发生了缺页，预读后面的页
+        read_ahead_queue_.Put(page_id + 1);
+    }
+
+    // 从磁盘读数据到frame上，读盘期间不持有分区的锁，命中其他page的请求不受影响
+    lock.unlock();
+    ScheduleIo(false, page_id, page->GetData()).get();
+    lock.lock();
+
+    page->version_.fetch_add(1, std::memory_order_release);
+    page->io_in_progress_ = false;
+    page->io_cv_.notify_all();
+
+    auto latency = std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now() - start);
+    instance.misses_[access_idx].fetch_add(1, std::memory_order_relaxed);
+    instance.miss_latency_us_[BufferPoolStats::LatencyBucket(latency.count())].fetch_add(1, std::memory_order_relaxed);
+    return page;
 }
 // to do
-auto BufferPoolManager::UnpinPage(page_id_t page_id, bool is_dirty, [[maybe_unused]] AccessType access_type) -> bool {
+void BufferPoolManager::PinFrame(BufferPoolInstance &instance, frame_id_t frame_id, AccessType access_type) {
+    Page &page = pages_[frame_id];
+    page_id_t page_id = page.GetPageId();
+    instance.replacer_->RecordAccess(ToLocalFrameId(frame_id), access_type, page_id);  // 确保frame存在于replacer中，并添加一条history
+    instance.replacer_->SetEvictable(ToLocalFrameId(frame_id), false);
+    page.pin_count_++;  // 引用计数加一
+    if (access_type == AccessType::Scan && page.read_ahead_) {
+        // 扫描命中了预读的页，说明预读有效，继续向后预读
+        page.read_ahead_ = false;
+        read_ahead_queue_.Put(page_id + 1);
+    }
+    if (access_type != AccessType::Scan) {
+        // 不是扫描的访问，说明页是热的，交给replacer管理
+        LeaveScanRing(instance, frame_id);
+    }
+}
+
+auto BufferPoolManager::FetchPages(const std::vector<page_id_t> &page_ids, AccessType access_type)
+    -> std::vector<BasicPageGuard> {
+    if (std::any_of(page_ids.begin(), page_ids.end(), [](page_id_t page_id) { return page_id < 0; })) {
+        return {};
+    }
+    auto access_idx = static_cast<size_t>(access_type);
+    std::vector<Page *> pages(page_ids.size(), nullptr);
+
+    // 第一遍：无锁地pin住所有已经在内存中的页
+    std::vector<size_t> misses;
+    for (size_t i = 0; i < page_ids.size(); ++i) {
+        BufferPoolInstance &instance = GetInstance(page_ids[i]);
+        pages[i] = PinResidentPage(instance, page_ids[i], access_type);
+        if (pages[i] != nullptr) {
+            instance.hits_[access_idx].fetch_add(1, std::memory_order_relaxed);
+        } else {
+            misses.push_back(i);
+        }
+    }
 
-    std::lock_guard<std::mutex> lock(latch_);
-    auto target = page_table_.find(page_id);
+    // 第二遍：缺页按分区和page id排序，每个分区只加一次锁，为所有缺页预留frame并发出读请求，最后统一等待
+    std::sort(misses.begin(), misses.end(), [&](size_t a, size_t b) {
+        return std::make_pair(page_ids[a] % num_instances_, page_ids[a]) <
+               std::make_pair(page_ids[b] % num_instances_, page_ids[b]);
+    });
+    auto start = std::chrono::steady_clock::now();
+    std::vector<std::pair<size_t, std::future<bool>>> reads;
+    // 同一批中重复的缺页，等第一次出现的页读完后再pin：(重复的下标, 第一次出现的下标)
+    std::vector<std::pair<size_t, size_t>> duplicates;
+    bool failed = false;
+    for (size_t m = 0; m < misses.size() && !failed;) {
+        BufferPoolInstance &instance = GetInstance(page_ids[misses[m]]);
+        std::unique_lock<std::mutex> lock(instance.latch_);
+        DrainAccesses(instance);
+        size_t first = m;
+        size_t owner = misses[m];  // 当前page id第一次出现的下标
+        for (; m < misses.size() && page_ids[misses[m]] % num_instances_ == instance.index_; ++m) {
+            size_t i = misses[m];
+            page_id_t page_id = page_ids[i];
+            if (m > first && page_ids[misses[m - 1]] == page_id) {
+                // 不能在FindFrame中等待自己发出的读请求
+                duplicates.emplace_back(i, owner);
+                continue;
+            }
+            owner = i;
+            frame_id_t frame_id = FindFrame(lock, instance, page_id);
+            if (frame_id != -1) {
+                // 第一遍之后被其他线程读入了
+                PinFrame(instance, frame_id, access_type);
+                pages[i] = pages_ + frame_id;
+                instance.hits_[access_idx].fetch_add(1, std::memory_order_relaxed);
+                continue;
+            }
+            pages[i] = ReserveFrame(instance, lock, page_id, frame_id, access_type);
+            if (pages[i] == nullptr) {
+                // 缓存满，放弃整批
+                failed = true;
+                break;
+            }
+            reads.emplace_back(i, ScheduleIo(false, page_id, pages[i]->GetData()));
+        }
+    }
+    if (access_type == AccessType::Scan && !reads.empty()) {
+        // 顺序扫描发生了缺页，预读最后一个缺页之后的页
+        page_id_t last_page_id = 0;
+        for (auto &read : reads) {
+            last_page_id = std::max(last_page_id, page_ids[read.first]);
+        }
+        read_ahead_queue_.Put(last_page_id + 1);
+    }
 
-    //合法性判断
-    if (target == page_table_.end() || pages_[target->second].GetPinCount() == 0) {
-        return false;
+    for (auto &[i, future] : reads) {
+        future.get();
+        Page *page = pages[i];
+        BufferPoolInstance &instance = GetInstance(page_ids[i]);
+        {
+            std::lock_guard<std::mutex> lock(instance.latch_);
+            page->version_.fetch_add(1, std::memory_order_release);
+            page->io_in_progress_ = false;
+            page->io_cv_.notify_all();
+        }
+        auto latency = std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now() - start);
+        instance.misses_[access_idx].fetch_add(1, std::memory_order_relaxed);
+        instance.miss_latency_us_[BufferPoolStats::LatencyBucket(latency.count())].fetch_add(
+            1, std::memory_order_relaxed);
+    }
+    for (auto [i, first] : duplicates) {
+        if (pages[first] != nullptr) {
+            // 第一次出现的页还pin着，不会被换出
+            pages[first]->pin_count_++;
+            pages[i] = pages[first];
+        }
     }
-    frame_id_t frame_id = target->second;
-    BUSTUB_ASSERT(page_id == pages_[frame_id].GetPageId(), "");
 
-    pages_[frame_id].pin_count_--;
-    BUSTUB_ASSERT(pages_[frame_id].GetPinCount() >= 0, "");
+    std::vector<BasicPageGuard> guards;
+    guards.reserve(page_ids.size());
+    for (Page *page : pages) {
+        guards.emplace_back(this, page);
+    }
+    if (failed) {
+        // guard析构时unpin已经pin住的页
+        return {};
+    }
+    return guards;
+}
 
-    if (pages_[frame_id].GetPinCount() == 0) {
-        replacer_->SetEvictable(frame_id, true);
+auto BufferPoolManager::UnpinPage(page_id_t page_id, bool is_dirty, [[maybe_unused]] AccessType access_type) -> bool {
+    if (page_id < 0) {
+        return false;
+    }
+    BufferPoolInstance &instance = GetInstance(page_id);
+    // 调用者pin住了该页，frame不会被换出，不加锁查找即可；查找失败时再加锁确认
+    frame_id_t frame_id = instance.page_table_->Find(page_id);
+    if (frame_id == -1 || pages_[frame_id].GetPageId() != page_id) {
+        std::unique_lock<std::mutex> lock(instance.latch_);
+        frame_id = FindFrame(lock, instance, page_id);
+    }
+
+    //合法性判断
+    if (frame_id == -1 || pages_[frame_id].GetPinCount() <= 0) {
+        return false;
     }
 
+    // 先标记脏页再unpin，unpin之后frame随时可能被写回
     if (is_dirty == true) {
         pages_[frame_id].is_dirty_ = true;
     }
-    return true;;
+    return UnpinFrame(instance, frame_id);
 }
 
 auto BufferPoolManager::FlushPage(page_id_t page_id) -> bool {
-    std::lock_guard<std::mutex> lock(latch_);
-    auto target = page_table_.find(page_id);
+    if (page_id < 0) {
+        return false;
+    }
+    BufferPoolInstance &instance = GetInstance(page_id);
+    std::unique_lock<std::mutex> lock(instance.latch_);
+    frame_id_t frame_id = FindFrame(lock, instance, page_id);
 
-    if (target == page_table_.end()) {
+    if (frame_id == -1) {
         // page 不在内存中
         return false;
     }
-    frame_id_t frame_id = target->second;
-    
 
-    BUSTUB_ASSERT(page_id == pages_[frame_id].GetPageId(), "");
-    // flush
-    disk_manager_->WritePage(page_id, pages_[frame_id].GetData());
-    pages_[frame_id].is_dirty_ = false;
+    // pin住frame防止写盘期间被驱除，写盘时不持有分区的锁，命中其他page的请求不受影响
+    Page &page = pages_[frame_id];
+    page.pin_count_++;
+    instance.replacer_->SetEvictable(ToLocalFrameId(frame_id), false);
+    // 写盘期间对该页的修改会在unpin时重新标记为脏页
+    page.is_dirty_ = false;
+    lock.unlock();
 
+    // flush
+    ScheduleIo(true, page_id, page.GetData()).get();
+    UnpinFrame(instance, frame_id);
     return true;
 }
 
 
 void BufferPoolManager::FlushAllPages() {
-    std::lock_guard<std::mutex> lock(latch_);
-
-    for (const auto & it : page_table_) {
-        page_id_t page_id = it.first;
-        frame_id_t frame_id = it.second;
-
-
-        BUSTUB_ASSERT(page_id == pages_[frame_id].GetPageId(), "");
-        // flush
-        disk_manager_->WritePage(page_id, pages_[frame_id].GetData());
-        pages_[frame_id].is_dirty_ = false;
+    // 分区的锁只在收集脏页时持有，写盘期间不阻塞其他线程的fetch
+    std::vector<std::pair<page_id_t, frame_id_t>> dirty_pages;
+    for (auto &instance : instances_) {
+        std::lock_guard<std::mutex> lock(instance->latch_);
+        instance->page_table_->ForEach([&](page_id_t page_id, frame_id_t frame_id) {
+            // 正在读盘或写回的frame，内容不属于page_id；干净的页不需要写
+            if (!pages_[frame_id].io_in_progress_ && pages_[frame_id].is_dirty_) {
+                dirty_pages.emplace_back(page_id, frame_id);
+            }
+        });
+    }
+    // 按page id排序，相邻的页合并成一次写
+    std::sort(dirty_pages.begin(), dirty_pages.end());
+
+    page_id_t first_page_id = INVALID_PAGE_ID;
+    std::vector<frame_id_t> run;
+    run.reserve(FLUSH_BATCH_PAGES);
+    for (auto [page_id, frame_id] : dirty_pages) {
+        if (!run.empty() && (page_id != first_page_id + static_cast<page_id_t>(run.size()) ||
+                             run.size() == static_cast<size_t>(FLUSH_BATCH_PAGES))) {
+            WriteRun(first_page_id, run);
+        }
+        // 无锁pin住frame，写盘期间它不会被驱除；收集之后frame可能已经换给了其他page
+        Page &page = pages_[frame_id];
+        if (!TryPin(page)) {
+            continue;
+        }
+        if (page.GetPageId() != page_id || page.io_in_progress_) {
+            UnpinFrame(GetInstance(page_id), frame_id);
+            continue;
+        }
+        // 写盘期间持有读latch，页的内容不会变化。只在不持有其他latch时阻塞等待，避免和持有写latch的线程死锁
+        if (!page.TryRLatch()) {
+            if (!run.empty()) {
+                WriteRun(first_page_id, run);
+            }
+            page.RLatch();
+        }
+        if (!page.is_dirty_) {
+            // 期间已经被驱除前的写回或者后台写回清理过了
+            page.RUnlatch();
+            UnpinFrame(GetInstance(page_id), frame_id);
+            continue;
+        }
+        // 写盘期间对该页的修改会在unpin时重新标记为脏页
+        page.is_dirty_ = false;
+        if (run.empty()) {
+            first_page_id = page_id;
+        }
+        run.push_back(frame_id);
+    }
+    if (!run.empty()) {
+        WriteRun(first_page_id, run);
+    }
+}
 
+void BufferPoolManager::WriteRun(page_id_t first_page_id, std::vector<frame_id_t> &run) {
+    std::vector<const char *> pages_data;
+    pages_data.reserve(run.size());
+    for (frame_id_t frame_id : run) {
+        pages_data.push_back(pages_[frame_id].GetData());
+    }
+    disk_manager_->WritePages(first_page_id, pages_data);
+    for (size_t i = 0; i < run.size(); ++i) {
+        pages_[run[i]].RUnlatch();
+        UnpinFrame(GetInstance(first_page_id + static_cast<page_id_t>(i)), run[i]);
     }
+    run.clear();
 }
 
 auto BufferPoolManager::DeletePage(page_id_t page_id) -> bool {
-    std::lock_guard<std::mutex> lock(latch_);
-
-    auto target = page_table_.find(page_id);
+    if (page_id < 0) {
+        return true;
+    }
+    BufferPoolInstance &instance = GetInstance(page_id);
+    std::unique_lock<std::mutex> lock(instance.latch_);
+    frame_id_t frame_id = FindFrame(lock, instance, page_id);
 
-    if (target == page_table_.end()) {
-        // page 不在内存中
+    if (frame_id == -1) {
+        // page 不在内存中，只需要释放磁盘上的page
+        DeallocatePage(page_id);
         return true;
     }
 
 
-    if (pages_[target->second].GetPinCount() > 0) {
+    if (!TryClaimFrame(pages_[frame_id])) {
+        // page被pin住
         return false;
     }
-    frame_id_t frame_id = target->second;
-    // 确定该page可以删除
-    BUSTUB_ASSERT(page_id == pages_[frame_id].GetPageId(), "");
-    BUSTUB_ASSERT(pages_[frame_id].GetPinCount() == 0, "");
-
-    if (pages_[frame_id].is_dirty_ == true) {
-        // 脏页写回磁盘
-        disk_manager_->WritePage(page_id, pages_[frame_id].GetData());
-    }
+    // 确定该page可以删除，page id马上会被释放并复用，脏页直接丢弃，不写回磁盘
     pages_[frame_id].ResetMemory();
     // 删除访问历史，停止追踪
-    replacer_->Remove(frame_id);
+    instance.replacer_->SetEvictable(ToLocalFrameId(frame_id), true);
+    instance.replacer_->Remove(ToLocalFrameId(frame_id));
+    LeaveScanRing(instance, frame_id);
     // 从page_table中删除 page_id -> frame_id的映射
-    page_table_.erase(page_id);
+    instance.page_table_->Erase(page_id);
 
     DeallocatePage(page_id);
     pages_[frame_id].page_id_ = INVALID_PAGE_ID;
-    pages_[frame_id].pin_count_ = 0;
     pages_[frame_id].is_dirty_ = false;
+    pages_[frame_id].version_.fetch_add(1, std::memory_order_release);
+    pages_[frame_id].pin_count_ = 0;
 
 
-    free_list_.push_back(frame_id);
+    instance.free_list_.push_back(frame_id);
+    return true;
+}
+
+auto BufferPoolManager::Resize(size_t pool_size) -> bool {
+    std::lock_guard<std::mutex> resize_lock(resize_latch_);
+    if (pool_size < num_instances_ || pool_size > max_pool_size_) {
+        return false;
+    }
+    // 扩容：新的frame直接放进所属分区的空闲链表
+    for (size_t frame_id = pool_size_; frame_id < pool_size; ++frame_id) {
+        BufferPoolInstance &instance = *instances_[frame_id % num_instances_];
+        std::lock_guard<std::mutex> lock(instance.latch_);
+        pages_[frame_id].pin_count_ = 0;
+        instance.free_list_.push_back(static_cast<frame_id_t>(frame_id));
+        pool_size_ = frame_id + 1;
+    }
+    // 缩容：从最高的frame开始逐个停用，始终只使用[0, pool_size_)
+    while (pool_size_ > pool_size) {
+        auto frame_id = static_cast<frame_id_t>(pool_size_ - 1);
+        BufferPoolInstance &instance = *instances_[frame_id % num_instances_];
+        std::lock_guard<std::mutex> lock(instance.latch_);
+        if (!RetireFrame(instance, frame_id)) {
+            return false;
+        }
+        pool_size_--;
+    }
+    return true;
+}
+
+auto BufferPoolManager::RetireFrame(BufferPoolInstance &instance, frame_id_t frame_id) -> bool {
+    Page &page = pages_[frame_id];
+    auto it = std::find(instance.free_list_.begin(), instance.free_list_.end(), frame_id);
+    if (it != instance.free_list_.end()) {
+        // 空闲的frame没有被replacer追踪，也不在页表中
+        instance.free_list_.erase(it);
+        page.pin_count_ = -1;
+        // 扩容时frame直接回到空闲链表，NewPage认为它已清零；Release只是把内存还给系统的提示
+        page.ResetMemory();
+        arena_->Release(frame_id);
+        return true;
+    }
+    if (!TryClaimFrame(page)) {
+        // 被pin住，或者正在被驱除、读入
+        return false;
+    }
+    page_id_t page_id = page.page_id_;
+    if (page.is_dirty_) {
+        ScheduleIo(true, page_id, page.GetData()).get();
+    }
+    instance.replacer_->SetEvictable(ToLocalFrameId(frame_id), true);
+    instance.replacer_->Remove(ToLocalFrameId(frame_id));
+    LeaveScanRing(instance, frame_id);
+    instance.page_table_->Erase(page_id);
+    page.page_id_ = INVALID_PAGE_ID;
+    page.is_dirty_ = false;
+    page.read_ahead_ = false;
+    // 版本号恢复为偶数，frame保持被占住，直到再次扩容
+    page.version_.fetch_add(1, std::memory_order_release);
+    page.ResetMemory();
+    arena_->Release(frame_id);
     return true;
 }
 
-auto BufferPoolManager::AllocatePage() -> page_id_t { return next_page_id_++; }
+auto BufferPoolManager::GetStats() -> BufferPoolStats {
+    BufferPoolStats stats;
+    for (auto &instance : instances_) {
+        for (size_t i = 0; i < NUM_ACCESS_TYPES; ++i) {
+            stats.hits_[i] += instance->hits_[i].load(std::memory_order_relaxed);
+            stats.misses_[i] += instance->misses_[i].load(std::memory_order_relaxed);
+        }
+        stats.evictions_ += instance->evictions_.load(std::memory_order_relaxed);
+        stats.dirty_evictions_ += instance->dirty_evictions_.load(std::memory_order_relaxed);
+        for (size_t i = 0; i < MISS_LATENCY_BUCKETS; ++i) {
+            stats.miss_latency_us_[i] += instance->miss_latency_us_[i].load(std::memory_order_relaxed);
+        }
+        std::lock_guard<std::mutex> lock(instance->latch_);
+        stats.free_frames_ += instance->free_list_.size();
+    }
+    return stats;
+}
+
+void BufferPoolManager::ResetStats() {
+    for (auto &instance : instances_) {
+        for (size_t i = 0; i < NUM_ACCESS_TYPES; ++i) {
+            instance->hits_[i] = 0;
+            instance->misses_[i] = 0;
+        }
+        instance->evictions_ = 0;
+        instance->dirty_evictions_ = 0;
+        for (auto &bucket : instance->miss_latency_us_) {
+            bucket = 0;
+        }
+    }
+}
+
+auto BufferPoolManager::AllocatePage(page_id_t segment) -> page_id_t { return disk_manager_->AllocatePage(segment); }
+
+auto BufferPoolManager::ScheduleIo(bool is_write, page_id_t page_id, char *data) -> std::future<bool> {
+    auto promise = disk_scheduler_->CreatePromise();
+    auto future = promise.get_future();
+    disk_scheduler_->Schedule({is_write, data, page_id, std::move(promise)});
+    return future;
+}
 
-auto BufferPoolManager::FetchPageBasic(page_id_t page_id) -> BasicPageGuard {
-    return {this, FetchPage(page_id)};
+auto BufferPoolManager::FetchPageBasic(page_id_t page_id, AccessType access_type) -> BasicPageGuard {
+    return {this, FetchPage(page_id, access_type)};
 }
 
-auto BufferPoolManager::FetchPageRead(page_id_t page_id) -> ReadPageGuard {
-    return {this, FetchPage(page_id)};
+auto BufferPoolManager::FetchPageRead(page_id_t page_id, AccessType access_type) -> ReadPageGuard {
+    return {this, FetchPage(page_id, access_type)};
+}
+
+auto BufferPoolManager::FetchPageWrite(page_id_t page_id, AccessType access_type) -> WritePageGuard {
+    return {this, FetchPage(page_id, access_type)}; }
+
+auto BufferPoolManager::FetchPageUpgradable(page_id_t page_id, AccessType access_type) -> UpgradablePageGuard {
+    return {this, FetchPage(page_id, access_type)};
 }
 
-auto BufferPoolManager::FetchPageWrite(page_id_t page_id) -> WritePageGuard {
-    return {this, FetchPage(page_id)}; }
+auto BufferPoolManager::FetchPageOptimistic(page_id_t page_id) -> OptimisticPageGuard {
+    if (page_id < 0) {
+        return {};
+    }
+    BufferPoolInstance &instance = GetInstance(page_id);
+    frame_id_t frame_id = instance.page_table_->Find(page_id);
+    if (frame_id == -1) {
+        return {};
+    }
+    Page *page = pages_ + frame_id;
+    // 先读版本号，再确认frame装的是page_id：之后frame被换出或修改，版本号一定会变
+    uint64_t version = page->ReadVersion();
+    if (version % 2 == 1 || page->GetPageId() != page_id || page->io_in_progress_) {
+        return {};
+    }
+    // 乐观读不修改任何共享的状态，只是偶尔把访问交给replacer，让常用的内部节点不被换出
+    thread_local uint32_t num_optimistic_reads = 0;
+    if (num_optimistic_reads++ % OPTIMISTIC_ACCESS_SAMPLE == 0) {
+        size_t slot = instance.access_write_.fetch_add(1) % BufferPoolInstance::ACCESS_BUFFER_SIZE;
+        instance.access_buffer_[slot] = frame_id;
+    }
+    return {page, page_id, version};
+}
 
-auto BufferPoolManager::NewPageGuarded(page_id_t *page_id) -> BasicPageGuard {
-    return {this, NewPage(page_id)};
+auto BufferPoolManager::NewPageGuarded(page_id_t *page_id, page_id_t segment) -> BasicPageGuard {
+    return {this, NewPage(page_id, segment)};
 }
 
 }  // namespace bustub
@@ -0,0 +1,82 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// buffer_pool_stats.cpp
+//
+// Identification: src/buffer/buffer_pool_stats.cpp
+//
+// Copyright (c) 2015-2023, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#include "buffer/buffer_pool_stats.h"
+
+#include "fmt/format.h"
+
+namespace bustub {
+
+auto BufferPoolStats::LatencyBucket(uint64_t latency_us) -> size_t {
+  size_t bucket = 0;
+  while (latency_us > 0 && bucket < MISS_LATENCY_BUCKETS - 1) {
+    latency_us >>= 1;
+    bucket++;
+  }
+  return bucket;
+}
+
+auto BufferPoolStats::AccessTypeName(AccessType access_type) -> const char * {
+  switch (access_type) {
+    case AccessType::Unknown:
+      return "unknown";
+    case AccessType::Get:
+      return "get";
+    case AccessType::Scan:
+      return "scan";
+  }
+  return "invalid";
+}
+
+auto BufferPoolStats::HitRatio() const -> double {
+  uint64_t hits = 0;
+  uint64_t fetches = 0;
+  for (size_t i = 0; i < NUM_ACCESS_TYPES; ++i) {
+    hits += hits_[i];
+    fetches += hits_[i] + misses_[i];
+  }
+  return fetches == 0 ? 0 : static_cast<double>(hits) / static_cast<double>(fetches);
+}
+
+auto BufferPoolStats::MissLatencyPercentile(double percentile) const -> uint64_t {
+  uint64_t total = 0;
+  for (auto count : miss_latency_us_) {
+    total += count;
+  }
+  if (total == 0) {
+    return 0;
+  }
+  auto rank = static_cast<uint64_t>(percentile / 100 * static_cast<double>(total));
+  uint64_t seen = 0;
+  for (size_t i = 0; i < MISS_LATENCY_BUCKETS; ++i) {
+    seen += miss_latency_us_[i];
+    if (seen > rank || i == MISS_LATENCY_BUCKETS - 1) {
+      return uint64_t{1} << i;
+    }
+  }
+  return 0;
+}
+
+auto BufferPoolStats::ToString() const -> std::string {
+  std::string result;
+  for (size_t i = 0; i < NUM_ACCESS_TYPES; ++i) {
+    result += fmt::format("{}: hits={} misses={}\n", AccessTypeName(static_cast<AccessType>(i)), hits_[i], misses_[i]);
+  }
+  result += fmt::format("hit_ratio: {:.4f}\n", HitRatio());
+  result += fmt::format("evictions: {} dirty_evictions: {}\n", evictions_, dirty_evictions_);
+  result += fmt::format("free_frames: {}\n", free_frames_);
+  result += fmt::format("miss_latency_us: p50<={} p90<={} p99<={}\n", MissLatencyPercentile(50),
+                        MissLatencyPercentile(90), MissLatencyPercentile(99));
+  return result;
+}
+
+}  // namespace bustub
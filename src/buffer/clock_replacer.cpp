@@ -14,16 +14,88 @@
 
 namespace bustub {
 
-ClockReplacer::ClockReplacer(size_t num_pages) {}
+ClockReplacer::ClockReplacer(size_t num_pages) : slots_(num_pages) {}
 
 ClockReplacer::~ClockReplacer() = default;
 
-auto ClockReplacer::Victim(frame_id_t *frame_id) -> bool { return false; }
+auto ClockReplacer::Evict(frame_id_t *frame_id) -> bool {
+  std::lock_guard<std::mutex> lock(latch_);
+  if (curr_size_ == 0) {
+    return false;
+  }
+  // Two full turns are enough: the first one clears every reference bit it passes.
+  for (size_t step = 0; step < 2 * slots_.size() + 1; step++) {
+    size_t pos = hand_;
+    hand_ = (hand_ + 1) % slots_.size();
+    Slot &slot = slots_[pos];
+    if (!slot.evictable_) {
+      continue;
+    }
+    if (slot.referenced_) {
+      slot.referenced_ = false;
+      continue;
+    }
+    slot = Slot();
+    curr_size_--;
+    *frame_id = static_cast<frame_id_t>(pos);
+    return true;
+  }
+  UNREACHABLE("an evictable frame must be found within two turns of the hand");
+}
 
-void ClockReplacer::Pin(frame_id_t frame_id) {}
+void ClockReplacer::RecordAccess(frame_id_t frame_id, [[maybe_unused]] AccessType access_type,
+                                 [[maybe_unused]] page_id_t page_id) {
+  std::lock_guard<std::mutex> lock(latch_);
+  BUSTUB_ASSERT(frame_id >= 0 && static_cast<size_t>(frame_id) < slots_.size(), "invalid frame id");
+  Slot &slot = slots_[frame_id];
+  slot.tracked_ = true;
+  slot.referenced_ = true;
+}
 
-void ClockReplacer::Unpin(frame_id_t frame_id) {}
+void ClockReplacer::SetEvictable(frame_id_t frame_id, bool set_evictable) {
+  std::lock_guard<std::mutex> lock(latch_);
+  BUSTUB_ASSERT(frame_id >= 0 && static_cast<size_t>(frame_id) < slots_.size(), "invalid frame id");
+  Slot &slot = slots_[frame_id];
+  if (!slot.tracked_ || slot.evictable_ == set_evictable) {
+    return;
+  }
+  slot.evictable_ = set_evictable;
+  if (set_evictable) {
+    curr_size_++;
+  } else {
+    curr_size_--;
+  }
+}
 
-auto ClockReplacer::Size() -> size_t { return 0; }
+void ClockReplacer::Remove(frame_id_t frame_id) {
+  std::lock_guard<std::mutex> lock(latch_);
+  BUSTUB_ASSERT(frame_id >= 0 && static_cast<size_t>(frame_id) < slots_.size(), "invalid frame id");
+  Slot &slot = slots_[frame_id];
+  if (!slot.tracked_) {
+    return;
+  }
+  BUSTUB_ASSERT(slot.evictable_, "cannot remove a non-evictable frame");
+  slot = Slot();
+  curr_size_--;
+}
+
+auto ClockReplacer::Size() -> size_t {
+  std::lock_guard<std::mutex> lock(latch_);
+  return curr_size_;
+}
+
+auto ClockReplacer::EvictionCandidates(size_t max_num) -> std::vector<frame_id_t> {
+  std::lock_guard<std::mutex> lock(latch_);
+  std::vector<frame_id_t> candidates;
+  for (bool referenced : {false, true}) {
+    for (size_t i = 0; i < slots_.size() && candidates.size() < max_num; i++) {
+      size_t pos = (hand_ + i) % slots_.size();
+      if (slots_[pos].evictable_ && slots_[pos].referenced_ == referenced) {
+        candidates.push_back(static_cast<frame_id_t>(pos));
+      }
+    }
+  }
+  return candidates;
+}
 
 }  // namespace bustub
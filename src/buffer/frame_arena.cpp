@@ -0,0 +1,99 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// frame_arena.cpp
+//
+// Identification: src/buffer/frame_arena.cpp
+//
+// Copyright (c) 2015-2023, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#include "buffer/frame_arena.h"
+
+#include <sys/mman.h>
+#include <cstring>
+
+#include "common/exception.h"
+
+#if defined(__SANITIZE_ADDRESS__)
+#define BUSTUB_FRAME_ARENA_ASAN
+#elif defined(__has_feature)
+#if __has_feature(address_sanitizer)
+#define BUSTUB_FRAME_ARENA_ASAN
+#endif
+#endif
+
+#ifdef BUSTUB_FRAME_ARENA_ASAN
+#include <sanitizer/asan_interface.h>
+#endif
+
+namespace bustub {
+
+namespace {
+/** Size of an explicit huge page on x86-64 and aarch64 with 4K base pages. */
+constexpr size_t HUGE_PAGE_SIZE = 2 * 1024 * 1024;
+}  // namespace
+
+FrameArena::FrameArena(size_t num_frames, bool use_huge_pages, size_t page_size)
+    : num_frames_(num_frames), page_size_(page_size) {
+#ifdef BUSTUB_FRAME_ARENA_ASAN
+  // leave a guard page after every frame
+  frame_stride_ = 2 * page_size_;
+#else
+  frame_stride_ = page_size_;
+#endif
+  size_ = num_frames_ * frame_stride_;
+
+#ifdef MAP_HUGETLB
+  if (use_huge_pages) {
+    size_t huge_size = (size_ + HUGE_PAGE_SIZE - 1) / HUGE_PAGE_SIZE * HUGE_PAGE_SIZE;
+    void *memory = mmap(nullptr, huge_size, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS | MAP_HUGETLB, -1, 0);
+    if (memory != MAP_FAILED) {
+      memory_ = static_cast<char *>(memory);
+      size_ = huge_size;
+      huge_pages_ = true;
+    }
+  }
+#endif
+
+  if (memory_ == nullptr) {
+    // no explicit huge pages reserved by the system, fall back to normal pages
+    void *memory = mmap(nullptr, size_, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS | MAP_NORESERVE, -1, 0);
+    if (memory == MAP_FAILED) {
+      throw Exception(ExceptionType::OUT_OF_MEMORY, "cannot map the frames of the buffer pool");
+    }
+    memory_ = static_cast<char *>(memory);
+#ifdef MADV_HUGEPAGE
+    if (use_huge_pages) {
+      huge_pages_ = madvise(memory_, size_, MADV_HUGEPAGE) == 0;
+    }
+#endif
+  }
+
+#ifdef BUSTUB_FRAME_ARENA_ASAN
+  for (size_t i = 0; i < num_frames_; ++i) {
+    ASAN_POISON_MEMORY_REGION(GetFrame(i) + page_size_, frame_stride_ - page_size_);
+  }
+#endif
+}
+
+auto FrameArena::Release(size_t frame_idx) -> bool {
+  char *frame = GetFrame(frame_idx);
+  // fails with EINVAL on explicit huge pages, whose memory cannot be split
+  if (madvise(frame, page_size_, MADV_DONTNEED) == 0) {
+    return true;
+  }
+  std::memset(frame, 0, page_size_);
+  return false;
+}
+
+FrameArena::~FrameArena() {
+#ifdef BUSTUB_FRAME_ARENA_ASAN
+  ASAN_UNPOISON_MEMORY_REGION(memory_, size_);
+#endif
+  munmap(memory_, size_);
+}
+
+}  // namespace bustub
@@ -11,6 +11,9 @@
 //===----------------------------------------------------------------------===//
 
 #include "buffer/lru_k_replacer.h"
+
+#include <algorithm>
+
 #include "common/exception.h"
 
 namespace bustub {
@@ -19,53 +22,24 @@ LRUKReplacer::LRUKReplacer(size_t num_frames, size_t k) : replacer_size_(num_fra
 
 auto LRUKReplacer::Evict(frame_id_t *frame_id) -> bool {
     std::lock_guard<std::mutex> lock(latch_);
-    auto target = node_store_.end();
-    size_t target_dist_diff = 0;
-    if (node_store_.empty()) {    // 没有可Evict的帧
+    // 访问不足k次的帧backward k-distance为+inf，优先驱除，其中第一次访问最早的排在最前
+    std::set<EvictKey> &candidates = !less_k_frames_.empty() ? less_k_frames_ : k_frames_;
+    if (candidates.empty()) {    // 没有可Evict的帧
         return false;
     }
 
-    for(auto it = node_store_.begin(); it != node_store_.end(); it++) {
-        const LRUKNode& node = it->second;
-        size_t diff_dist = 0;
-        if (node.is_evictable_ == false)
-            continue;
-
-        if (node.history_.size() == node.k_) {    // 记录了k次历史
-            diff_dist = current_timestamp_ - node.history_.back(); // 和前k次时间戳做差
-        } else {  // 访问不足k次。
-            diff_dist = UINT64_MAX;
-        }
-
-        if (target_dist_diff < diff_dist) {    // 找到间隔更久的node
-            target = it;
-            target_dist_diff = diff_dist;
-        } else if (target_dist_diff == diff_dist) { // 相等就比较第kth个时间戳。
-            if (target->second.history_.empty()) {
-                // 为空代表存在一个无限小的时间戳
-                // 既然都无限小了，所以就没有更小的时间戳了
-                // continue即可。
-                continue;
-            } else if (node.history_.empty() || (target->second.history_.back() > node.history_.back())) {
-                target = it;
-                target_dist_diff = diff_dist;
-            }
-        }
-    }
-
-    if (target == node_store_.end()) {    // 找不到要剔除的frame
-        return false;
-    }
-    BUSTUB_ASSERT(target->second.is_evictable_ == true, "is_evictable_ == false!");
+    auto target = node_store_.find(candidates.begin()->second);
+    BUSTUB_ASSERT(target != node_store_.end() && target->second.is_evictable_ == true, "is_evictable_ == false!");
+    candidates.erase(candidates.begin());
     *frame_id = target->second.fid_;
     node_store_.erase(target);  // remove the frame's access history.
     BUSTUB_ASSERT(curr_size_ - 1 < curr_size_, "");
     curr_size_--;   // size decrement
-    // delete
     return true;
 }
 
-void LRUKReplacer::RecordAccess(frame_id_t frame_id, [[maybe_unused]] AccessType access_type) {
+void LRUKReplacer::RecordAccess(frame_id_t frame_id, [[maybe_unused]] AccessType access_type,
+                                [[maybe_unused]] page_id_t page_id) {
     std::lock_guard<std::mutex> lock(latch_);
     BUSTUB_ASSERT((frame_id != -1) && (frame_id < (frame_id_t)replacer_size_), "");
 
@@ -79,13 +53,21 @@ void LRUKReplacer::RecordAccess(frame_id_t frame_id, [[maybe_unused]] AccessType
         //curr_size_++;
         BUSTUB_ASSERT(curr_size_ <= replacer_size_, "");
     }
+    LRUKNode &node = target->second;
+    if (node.is_evictable_) {
+        // 排序的key即将变化，先从有序集合中摘除
+        EvictSetOf(node).erase({node.history_.back(), frame_id});
+    }
     // need mark to is_evictable_ == false?
-    if (target->second.history_.size() < target->second.k_) {
-        target->second.history_.push_front(++current_timestamp_);
+    if (node.history_.size() < node.k_) {
+        node.history_.push_front(++current_timestamp_);
     } else {  // ==
-        BUSTUB_ASSERT(target->second.history_.size() == target->second.k_, "");
-        target->second.history_.push_front(++current_timestamp_);
-        target->second.history_.pop_back();
+        BUSTUB_ASSERT(node.history_.size() == node.k_, "");
+        node.history_.push_front(++current_timestamp_);
+        node.history_.pop_back();
+    }
+    if (node.is_evictable_) {
+        EvictSetOf(node).insert({node.history_.back(), frame_id});
     }
 }
 
@@ -96,18 +78,20 @@ void LRUKReplacer::SetEvictable(frame_id_t frame_id, bool set_evictable) {
     auto target = node_store_.find(frame_id);
 
     if (target != node_store_.end()) {
-        if (target->second.is_evictable_ == true && set_evictable == false) {
-            target->second.is_evictable_ = false;
+        LRUKNode &node = target->second;
+        if (node.is_evictable_ == true && set_evictable == false) {
+            node.is_evictable_ = false;
+            EvictSetOf(node).erase({node.history_.back(), frame_id});
             BUSTUB_ASSERT(curr_size_ - 1 < curr_size_, "");
             curr_size_--;
-        } else if (target->second.is_evictable_ == false && set_evictable == true) {
-            target->second.is_evictable_ = true;
+        } else if (node.is_evictable_ == false && set_evictable == true) {
+            node.is_evictable_ = true;
+            EvictSetOf(node).insert({node.history_.back(), frame_id});
             curr_size_++;
             BUSTUB_ASSERT(curr_size_ <= replacer_size_, "");
         }
-    } else {// 什么也不做
-        BUSTUB_ASSERT(false, "");
     }
+    // 不在replacer中的frame什么也不做：无锁的unpin可能晚于驱除，此时frame已经不被追踪
     // 考虑可以自学习？
 }
 
@@ -118,12 +102,26 @@ void LRUKReplacer::Remove(frame_id_t frame_id) {
     auto target = node_store_.find(frame_id);
     if (target != node_store_.end()) {
         BUSTUB_ASSERT(target->second.is_evictable_  == true, "");
+        EvictSetOf(target->second).erase({target->second.history_.back(), frame_id});
         node_store_.erase(target);
         BUSTUB_ASSERT(curr_size_ - 1 < curr_size_, "");
         curr_size_--;
     }
 }
 
+auto LRUKReplacer::EvictionCandidates(size_t max_num) -> std::vector<frame_id_t> {
+    std::lock_guard<std::mutex> lock(latch_);
+    std::vector<frame_id_t> candidates;
+    candidates.reserve(std::min(max_num, curr_size_));
+    // 与Evict的顺序一致：先是访问不足k次的帧，再是访问满k次的帧
+    for (const auto *frames : {&less_k_frames_, &k_frames_}) {
+        for (auto it = frames->begin(); it != frames->end() && candidates.size() < max_num; ++it) {
+            candidates.push_back(it->second);
+        }
+    }
+    return candidates;
+}
+
 auto LRUKReplacer::Size() -> size_t {
     std::lock_guard<std::mutex> lock(latch_);
     return curr_size_; 
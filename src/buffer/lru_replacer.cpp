@@ -14,16 +14,75 @@
 
 namespace bustub {
 
-LRUReplacer::LRUReplacer(size_t num_pages) {}
+LRUReplacer::LRUReplacer(size_t num_pages) : nodes_(num_pages) {}
 
 LRUReplacer::~LRUReplacer() = default;
 
-auto LRUReplacer::Victim(frame_id_t *frame_id) -> bool { return false; }
+auto LRUReplacer::Evict(frame_id_t *frame_id) -> bool {
+  std::lock_guard<std::mutex> lock(latch_);
+  if (evictable_.empty()) {
+    return false;
+  }
+  *frame_id = evictable_.begin()->second;
+  evictable_.erase(evictable_.begin());
+  nodes_[*frame_id] = Node();
+  return true;
+}
 
-void LRUReplacer::Pin(frame_id_t frame_id) {}
+void LRUReplacer::RecordAccess(frame_id_t frame_id, [[maybe_unused]] AccessType access_type,
+                               [[maybe_unused]] page_id_t page_id) {
+  std::lock_guard<std::mutex> lock(latch_);
+  BUSTUB_ASSERT(frame_id >= 0 && static_cast<size_t>(frame_id) < nodes_.size(), "invalid frame id");
+  Node &node = nodes_[frame_id];
+  if (node.evictable_) {
+    evictable_.erase({node.last_access_, frame_id});
+  }
+  node.tracked_ = true;
+  node.last_access_ = ++current_timestamp_;
+  if (node.evictable_) {
+    evictable_.insert({node.last_access_, frame_id});
+  }
+}
 
-void LRUReplacer::Unpin(frame_id_t frame_id) {}
+void LRUReplacer::SetEvictable(frame_id_t frame_id, bool set_evictable) {
+  std::lock_guard<std::mutex> lock(latch_);
+  BUSTUB_ASSERT(frame_id >= 0 && static_cast<size_t>(frame_id) < nodes_.size(), "invalid frame id");
+  Node &node = nodes_[frame_id];
+  if (!node.tracked_ || node.evictable_ == set_evictable) {
+    return;
+  }
+  node.evictable_ = set_evictable;
+  if (set_evictable) {
+    evictable_.insert({node.last_access_, frame_id});
+  } else {
+    evictable_.erase({node.last_access_, frame_id});
+  }
+}
 
-auto LRUReplacer::Size() -> size_t { return 0; }
+void LRUReplacer::Remove(frame_id_t frame_id) {
+  std::lock_guard<std::mutex> lock(latch_);
+  BUSTUB_ASSERT(frame_id >= 0 && static_cast<size_t>(frame_id) < nodes_.size(), "invalid frame id");
+  Node &node = nodes_[frame_id];
+  if (!node.tracked_) {
+    return;
+  }
+  BUSTUB_ASSERT(node.evictable_, "cannot remove a non-evictable frame");
+  evictable_.erase({node.last_access_, frame_id});
+  node = Node();
+}
+
+auto LRUReplacer::Size() -> size_t {
+  std::lock_guard<std::mutex> lock(latch_);
+  return evictable_.size();
+}
+
+auto LRUReplacer::EvictionCandidates(size_t max_num) -> std::vector<frame_id_t> {
+  std::lock_guard<std::mutex> lock(latch_);
+  std::vector<frame_id_t> candidates;
+  for (auto it = evictable_.begin(); it != evictable_.end() && candidates.size() < max_num; ++it) {
+    candidates.push_back(it->second);
+  }
+  return candidates;
+}
 
 }  // namespace bustub
@@ -0,0 +1,95 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// page_table.cpp
+//
+// Identification: src/buffer/page_table.cpp
+//
+// Copyright (c) 2015-2023, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#include "buffer/page_table.h"
+
+namespace bustub {
+
+PageTable::PageTable(size_t max_entries) {
+  // keep the load factor under 1/2 so the probe sequences stay short
+  size_t num_slots = 2;
+  int bits = 1;
+  while (num_slots < 2 * max_entries) {
+    num_slots <<= 1;
+    bits++;
+  }
+  mask_ = num_slots - 1;
+  shift_ = 64 - bits;
+  slots_ = std::make_unique<std::atomic<uint64_t>[]>(num_slots);
+  for (size_t i = 0; i < num_slots; ++i) {
+    slots_[i].store(EMPTY_SLOT, std::memory_order_relaxed);
+  }
+}
+
+auto PageTable::Find(page_id_t page_id) const -> frame_id_t {
+  for (size_t i = HomeOf(page_id), probes = 0; probes <= mask_; i = (i + 1) & mask_, ++probes) {
+    uint64_t slot = slots_[i].load(std::memory_order_acquire);
+    if (slot == EMPTY_SLOT) {
+      return -1;
+    }
+    if (PageIdOf(slot) == page_id) {
+      return FrameIdOf(slot);
+    }
+  }
+  return -1;
+}
+
+void PageTable::Insert(page_id_t page_id, frame_id_t frame_id) {
+  BUSTUB_ASSERT(page_id != INVALID_PAGE_ID, "invalid page id");
+  for (size_t i = HomeOf(page_id);; i = (i + 1) & mask_) {
+    uint64_t slot = slots_[i].load(std::memory_order_relaxed);
+    if (slot == EMPTY_SLOT) {
+      BUSTUB_ASSERT(size_ < mask_, "page table is full");
+      slots_[i].store(Pack(page_id, frame_id), std::memory_order_release);
+      size_++;
+      return;
+    }
+    if (PageIdOf(slot) == page_id) {
+      slots_[i].store(Pack(page_id, frame_id), std::memory_order_release);
+      return;
+    }
+  }
+}
+
+auto PageTable::Erase(page_id_t page_id) -> bool {
+  size_t hole = HomeOf(page_id);
+  while (true) {
+    uint64_t slot = slots_[hole].load(std::memory_order_relaxed);
+    if (slot == EMPTY_SLOT) {
+      return false;
+    }
+    if (PageIdOf(slot) == page_id) {
+      break;
+    }
+    hole = (hole + 1) & mask_;
+  }
+
+  // Backward shift: move every following entry of the cluster that may not live after the hole into the hole.
+  for (size_t i = (hole + 1) & mask_;; i = (i + 1) & mask_) {
+    uint64_t slot = slots_[i].load(std::memory_order_relaxed);
+    if (slot == EMPTY_SLOT) {
+      break;
+    }
+    size_t home = HomeOf(PageIdOf(slot));
+    // the entry stays if its home lies cyclically in (hole, i]
+    bool stays = hole <= i ? (hole < home && home <= i) : (hole < home || home <= i);
+    if (!stays) {
+      slots_[hole].store(slot, std::memory_order_release);
+      hole = i;
+    }
+  }
+  slots_[hole].store(EMPTY_SLOT, std::memory_order_release);
+  size_--;
+  return true;
+}
+
+}  // namespace bustub
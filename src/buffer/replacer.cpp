@@ -0,0 +1,66 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// replacer.cpp
+//
+// Identification: src/buffer/replacer.cpp
+//
+// Copyright (c) 2015-2023, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#include "buffer/replacer.h"
+
+#include "buffer/arc_replacer.h"
+#include "buffer/clock_replacer.h"
+#include "buffer/lru_k_replacer.h"
+#include "buffer/lru_replacer.h"
+#include "buffer/two_queue_replacer.h"
+#include "common/exception.h"
+
+namespace bustub {
+
+auto MakeReplacer(ReplacerPolicy policy, size_t num_frames, size_t k) -> std::unique_ptr<Replacer> {
+  switch (policy) {
+    case ReplacerPolicy::LRU:
+      return std::make_unique<LRUReplacer>(num_frames);
+    case ReplacerPolicy::Clock:
+      return std::make_unique<ClockReplacer>(num_frames);
+    case ReplacerPolicy::LRUK:
+      return std::make_unique<LRUKReplacer>(num_frames, k);
+    case ReplacerPolicy::ARC:
+      return std::make_unique<ARCReplacer>(num_frames);
+    case ReplacerPolicy::TwoQ:
+      return std::make_unique<TwoQueueReplacer>(num_frames);
+  }
+  throw Exception(ExceptionType::INVALID, "unknown replacer policy");
+}
+
+auto ReplacerPolicyToString(ReplacerPolicy policy) -> std::string {
+  switch (policy) {
+    case ReplacerPolicy::LRU:
+      return "lru";
+    case ReplacerPolicy::Clock:
+      return "clock";
+    case ReplacerPolicy::LRUK:
+      return "lru-k";
+    case ReplacerPolicy::ARC:
+      return "arc";
+    case ReplacerPolicy::TwoQ:
+      return "2q";
+  }
+  return "invalid";
+}
+
+auto ParseReplacerPolicy(const std::string &name) -> ReplacerPolicy {
+  for (auto policy : {ReplacerPolicy::LRU, ReplacerPolicy::Clock, ReplacerPolicy::LRUK, ReplacerPolicy::ARC,
+                      ReplacerPolicy::TwoQ}) {
+    if (ReplacerPolicyToString(policy) == name) {
+      return policy;
+    }
+  }
+  throw Exception(ExceptionType::INVALID, "unknown replacer policy: " + name);
+}
+
+}  // namespace bustub
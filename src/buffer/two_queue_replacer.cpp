@@ -0,0 +1,138 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// two_queue_replacer.cpp
+//
+// Identification: src/buffer/two_queue_replacer.cpp
+//
+// Copyright (c) 2015-2022, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#include "buffer/two_queue_replacer.h"
+
+#include <algorithm>
+
+namespace bustub {
+
+TwoQueueReplacer::TwoQueueReplacer(size_t num_frames)
+    : nodes_(num_frames),
+      kin_(std::max<size_t>(num_frames / 4, 1)),
+      kout_(std::max<size_t>(num_frames / 2, 1)),
+      replacer_size_(num_frames) {}
+
+auto TwoQueueReplacer::VictimQueue() -> QueueId {
+  bool a1in_ready = !a1in_evictable_.empty();
+  bool am_ready = !am_evictable_.empty();
+  if (a1in_ready && (a1in_size_ > kin_ || !am_ready)) {
+    return QueueId::A1in;
+  }
+  return am_ready ? QueueId::Am : QueueId::None;
+}
+
+auto TwoQueueReplacer::Evict(frame_id_t *frame_id) -> bool {
+  std::lock_guard<std::mutex> lock(latch_);
+  QueueId queue = VictimQueue();
+  if (queue == QueueId::None) {
+    return false;
+  }
+  std::set<EvictKey> &candidates = EvictSetOf(queue);
+  *frame_id = candidates.begin()->second;
+  candidates.erase(candidates.begin());
+  Node &node = nodes_[*frame_id];
+  if (queue == QueueId::A1in) {
+    a1in_size_--;
+    if (node.page_id_ != INVALID_PAGE_ID) {
+      a1out_.push_front(node.page_id_);
+      a1out_index_[node.page_id_] = a1out_.begin();
+      if (a1out_.size() > kout_) {
+        a1out_index_.erase(a1out_.back());
+        a1out_.pop_back();
+      }
+    }
+  }
+  node = Node();
+  return true;
+}
+
+void TwoQueueReplacer::RecordAccess(frame_id_t frame_id, [[maybe_unused]] AccessType access_type,
+                                    page_id_t page_id) {
+  std::lock_guard<std::mutex> lock(latch_);
+  BUSTUB_ASSERT(frame_id >= 0 && static_cast<size_t>(frame_id) < replacer_size_, "invalid frame id");
+  Node &node = nodes_[frame_id];
+  if (node.queue_ == QueueId::A1in) {
+    // correlated reference, A1in stays in FIFO order
+    return;
+  }
+  if (node.evictable_) {
+    EvictSetOf(node.queue_).erase({node.timestamp_, frame_id});
+  }
+  if (node.queue_ == QueueId::None) {
+    auto ghost = page_id == INVALID_PAGE_ID ? a1out_index_.end() : a1out_index_.find(page_id);
+    if (ghost != a1out_index_.end()) {
+      a1out_.erase(ghost->second);
+      a1out_index_.erase(ghost);
+      node.queue_ = QueueId::Am;
+    } else {
+      node.queue_ = QueueId::A1in;
+      a1in_size_++;
+    }
+    node.page_id_ = page_id;
+  }
+  node.timestamp_ = ++current_timestamp_;
+  if (node.evictable_) {
+    EvictSetOf(node.queue_).insert({node.timestamp_, frame_id});
+  }
+}
+
+void TwoQueueReplacer::SetEvictable(frame_id_t frame_id, bool set_evictable) {
+  std::lock_guard<std::mutex> lock(latch_);
+  BUSTUB_ASSERT(frame_id >= 0 && static_cast<size_t>(frame_id) < replacer_size_, "invalid frame id");
+  Node &node = nodes_[frame_id];
+  if (node.queue_ == QueueId::None || node.evictable_ == set_evictable) {
+    return;
+  }
+  node.evictable_ = set_evictable;
+  if (set_evictable) {
+    EvictSetOf(node.queue_).insert({node.timestamp_, frame_id});
+  } else {
+    EvictSetOf(node.queue_).erase({node.timestamp_, frame_id});
+  }
+}
+
+void TwoQueueReplacer::Remove(frame_id_t frame_id) {
+  std::lock_guard<std::mutex> lock(latch_);
+  BUSTUB_ASSERT(frame_id >= 0 && static_cast<size_t>(frame_id) < replacer_size_, "invalid frame id");
+  Node &node = nodes_[frame_id];
+  if (node.queue_ == QueueId::None) {
+    return;
+  }
+  BUSTUB_ASSERT(node.evictable_, "cannot remove a non-evictable frame");
+  EvictSetOf(node.queue_).erase({node.timestamp_, frame_id});
+  if (node.queue_ == QueueId::A1in) {
+    a1in_size_--;
+  }
+  node = Node();
+}
+
+auto TwoQueueReplacer::Size() -> size_t {
+  std::lock_guard<std::mutex> lock(latch_);
+  return a1in_evictable_.size() + am_evictable_.size();
+}
+
+auto TwoQueueReplacer::EvictionCandidates(size_t max_num) -> std::vector<frame_id_t> {
+  std::lock_guard<std::mutex> lock(latch_);
+  std::vector<frame_id_t> candidates;
+  QueueId first = VictimQueue() == QueueId::Am ? QueueId::Am : QueueId::A1in;
+  QueueId second = first == QueueId::A1in ? QueueId::Am : QueueId::A1in;
+  for (QueueId queue : {first, second}) {
+    const std::set<EvictKey> &frames = EvictSetOf(queue);
+    for (auto it = frames.begin(); it != frames.end() && candidates.size() < max_num; ++it) {
+      candidates.push_back(it->second);
+    }
+  }
+  return candidates;
+}
+
+}  // namespace bustub
@@ -127,13 +127,43 @@ void BustubInstance::HandleExplainStatement(Transaction *txn, const ExplainState
 
 void BustubInstance::HandleVariableShowStatement(Transaction *txn, const VariableShowStatement &stmt,
                                                  ResultWriter &writer) {
-  auto content = GetSessionVariable(stmt.variable_);
+  std::string content;
+  if (stmt.variable_ == "buffer_pool_size" && buffer_pool_manager_ != nullptr) {
+    content = std::to_string(buffer_pool_manager_->GetPoolSize());
+  } else if (stmt.variable_ == "page_size") {
+    content = std::to_string(disk_manager_->GetPageSize());
+  } else {
+    content = GetSessionVariable(stmt.variable_);
+  }
   WriteOneCell(fmt::format("{}={}", stmt.variable_, content), writer);
 }
 
 void BustubInstance::HandleVariableSetStatement(Transaction *txn, const VariableSetStatement &stmt,
                                                 ResultWriter &writer) {
+  if (stmt.variable_ == "buffer_pool_size") {
+    ResizeBufferPool(stmt.value_);
+    return;
+  }
   session_variables_[stmt.variable_] = stmt.value_;
 }
 
+void BustubInstance::ResizeBufferPool(const std::string &value) {
+  if (buffer_pool_manager_ == nullptr) {
+    throw Exception(ExceptionType::EXECUTION, "buffer pool manager is not available");
+  }
+  size_t pool_size;
+  try {
+    pool_size = std::stoul(value);
+  } catch (const std::logic_error &e) {
+    throw Exception(ExceptionType::CONVERSION, fmt::format("invalid buffer_pool_size: {}", value));
+  }
+  if (!buffer_pool_manager_->Resize(pool_size)) {
+    throw Exception(ExceptionType::OUT_OF_RANGE,
+                    fmt::format("cannot resize the buffer pool to {} frames (at least {}, at most {}, pinned frames "
+                                "cannot be dropped), it has {} frames now",
+                                value, buffer_pool_manager_->GetNumInstances(), buffer_pool_manager_->GetMaxPoolSize(),
+                                buffer_pool_manager_->GetPoolSize()));
+  }
+}
+
 }  // namespace bustub
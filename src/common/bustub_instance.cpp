@@ -33,7 +33,9 @@
 #include "recovery/checkpoint_manager.h"
 #include "recovery/log_manager.h"
 #include "storage/disk/disk_manager.h"
+#include "storage/disk/disk_manager_compressed.h"
 #include "storage/disk/disk_manager_memory.h"
+#include "storage/disk/disk_manager_uring.h"
 #include "type/value_factory.h"
 
 namespace bustub {
@@ -42,11 +44,24 @@ auto BustubInstance::MakeExecutorContext(Transaction *txn, bool is_modify) -> st
   return std::make_unique<ExecutorContext>(txn, catalog_, buffer_pool_manager_, txn_manager_, lock_manager_, is_modify);
 }
 
-BustubInstance::BustubInstance(const std::string &db_file_name) {
+BustubInstance::BustubInstance(const std::string &db_file_name, size_t page_size, DiskBackend disk_backend) {
   enable_logging = false;
 
   // Storage related.
-  disk_manager_ = new DiskManager(db_file_name);
+  switch (disk_backend) {
+    case DiskBackend::Pread:
+      disk_manager_ = new DiskManager(db_file_name, page_size);
+      break;
+    case DiskBackend::DirectIo:
+      disk_manager_ = new DiskManager(db_file_name, page_size, true);
+      break;
+    case DiskBackend::IoUring:
+      disk_manager_ = new DiskManagerUring(db_file_name, page_size, true);
+      break;
+    case DiskBackend::Compressed:
+      disk_manager_ = new DiskManagerCompressed(db_file_name, page_size);
+      break;
+  }
 
   // Log related.
   log_manager_ = new LogManager(disk_manager_);
@@ -54,7 +69,11 @@ BustubInstance::BustubInstance(const std::string &db_file_name) {
   // We need more frames for GenerateTestTable to work. Therefore, we use 128 instead of the default
   // buffer pool size specified in `config.h`.
   try {
-    buffer_pool_manager_ = new BufferPoolManager(128, disk_manager_, LRUK_REPLACER_K, log_manager_);
+    buffer_pool_manager_ = new BufferPoolManager(128, disk_manager_, LRUK_REPLACER_K, log_manager_,
+                                                 BUFFER_POOL_INSTANCES, ReplacerPolicy::LRUK, BUFFER_POOL_MAX_SIZE);
+#ifndef __EMSCRIPTEN__
+    buffer_pool_manager_->StartBackgroundFlush(BACKGROUND_FLUSH_RESERVE);
+#endif
   } catch (NotImplementedException &e) {
     std::cerr << "BufferPoolManager is not implemented, only mock tables are supported." << std::endl;
     buffer_pool_manager_ = nullptr;
@@ -94,7 +113,11 @@ BustubInstance::BustubInstance() {
   // We need more frames for GenerateTestTable to work. Therefore, we use 128 instead of the default
   // buffer pool size specified in `config.h`.
   try {
-    buffer_pool_manager_ = new BufferPoolManager(128, disk_manager_, LRUK_REPLACER_K, log_manager_);
+    buffer_pool_manager_ = new BufferPoolManager(128, disk_manager_, LRUK_REPLACER_K, log_manager_,
+                                                 BUFFER_POOL_INSTANCES, ReplacerPolicy::LRUK, BUFFER_POOL_MAX_SIZE);
+#ifndef __EMSCRIPTEN__
+    buffer_pool_manager_->StartBackgroundFlush(BACKGROUND_FLUSH_RESERVE);
+#endif
   } catch (NotImplementedException &e) {
     std::cerr << "BufferPoolManager is not implemented, only mock tables are supported." << std::endl;
     buffer_pool_manager_ = nullptr;
@@ -163,6 +186,41 @@ void BustubInstance::CmdDisplayIndices(ResultWriter &writer) {
   writer.EndTable();
 }
 
+void BustubInstance::CmdDisplayBufferPoolStats(ResultWriter &writer) {
+  if (buffer_pool_manager_ == nullptr) {
+    WriteOneCell("buffer pool manager is not available", writer);
+    return;
+  }
+  auto stats = buffer_pool_manager_->GetStats();
+  writer.BeginTable(false);
+  writer.BeginHeader();
+  writer.WriteHeaderCell("stat");
+  writer.WriteHeaderCell("value");
+  writer.EndHeader();
+  auto write_row = [&writer](const std::string &name, const std::string &value) {
+    writer.BeginRow();
+    writer.WriteCell(name);
+    writer.WriteCell(value);
+    writer.EndRow();
+  };
+  for (size_t i = 0; i < NUM_ACCESS_TYPES; ++i) {
+    const char *access_type = BufferPoolStats::AccessTypeName(static_cast<AccessType>(i));
+    write_row(fmt::format("{}_hits", access_type), fmt::format("{}", stats.hits_[i]));
+    write_row(fmt::format("{}_misses", access_type), fmt::format("{}", stats.misses_[i]));
+  }
+  write_row("hit_ratio", fmt::format("{:.4f}", stats.HitRatio()));
+  write_row("evictions", fmt::format("{}", stats.evictions_));
+  write_row("dirty_evictions", fmt::format("{}", stats.dirty_evictions_));
+  write_row("pool_size", fmt::format("{}", buffer_pool_manager_->GetPoolSize()));
+  write_row("free_frames", fmt::format("{}", stats.free_frames_));
+  for (size_t i = 0; i < MISS_LATENCY_BUCKETS; ++i) {
+    if (stats.miss_latency_us_[i] > 0) {
+      write_row(fmt::format("miss_latency_us<{}", uint64_t{1} << i), fmt::format("{}", stats.miss_latency_us_[i]));
+    }
+  }
+  writer.EndTable();
+}
+
 void BustubInstance::WriteOneCell(const std::string &cell, ResultWriter &writer) {
   writer.BeginTable(true);
   writer.BeginRow();
@@ -176,6 +234,7 @@ void BustubInstance::CmdDisplayHelp(ResultWriter &writer) {
 
 \dt: show all tables
 \di: show all indices
+\bpm: show buffer pool statistics
 \help: show this message again
 
 BusTub shell currently only supports a small set of Postgres queries. We'll set
@@ -216,6 +275,10 @@ auto BustubInstance::ExecuteSqlTxn(const std::string &sql, ResultWriter &writer,
       CmdDisplayIndices(writer);
       return true;
     }
+    if (sql == "\\bpm") {
+      CmdDisplayBufferPoolStats(writer);
+      return true;
+    }
     if (sql == "\\help") {
       CmdDisplayHelp(writer);
       return true;
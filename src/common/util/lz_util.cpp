@@ -0,0 +1,182 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// lz_util.cpp
+//
+// Identification: src/common/util/lz_util.cpp
+//
+// Copyright (c) 2015-2023, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#include "common/util/lz_util.h"
+
+#include <algorithm>
+#include <array>
+#include <cstdint>
+#include <cstring>
+
+namespace bustub {
+
+namespace {
+
+constexpr size_t MIN_MATCH = 4;
+constexpr size_t MAX_OFFSET = 65535;
+constexpr size_t HASH_BITS = 12;
+
+auto Load32(const char *p) -> uint32_t {
+  uint32_t value;
+  memcpy(&value, p, sizeof(value));
+  return value;
+}
+
+auto Hash(uint32_t sequence) -> uint32_t { return (sequence * 2654435761U) >> (32 - HASH_BITS); }
+
+/** Writes the tokens of the compressed data, failing once capacity is exceeded. */
+class Writer {
+ public:
+  Writer(char *dst, size_t capacity) : dst_(dst), capacity_(capacity) {}
+
+  /** Write a token with its literals and, if match_length > 0, its match. @return false if it does not fit */
+  auto WriteSequence(const char *literals, size_t literal_length, size_t offset, size_t match_length) -> bool {
+    size_t match_code = match_length > 0 ? match_length - MIN_MATCH : 0;
+    auto token = static_cast<uint8_t>((std::min<size_t>(literal_length, 15) << 4) | std::min<size_t>(match_code, 15));
+    if (!Put(token) || !PutLength(literal_length) || !PutBytes(literals, literal_length)) {
+      return false;
+    }
+    if (match_length == 0) {
+      return true;
+    }
+    return Put(static_cast<uint8_t>(offset & 0xff)) && Put(static_cast<uint8_t>(offset >> 8)) &&
+           PutLength(match_code);
+  }
+
+  auto Size() const -> size_t { return size_; }
+
+ private:
+  auto Put(uint8_t byte) -> bool {
+    if (size_ >= capacity_) {
+      return false;
+    }
+    dst_[size_++] = static_cast<char>(byte);
+    return true;
+  }
+
+  /** The bytes extending a length that does not fit in its nibble. */
+  auto PutLength(size_t length) -> bool {
+    if (length < 15) {
+      return true;
+    }
+    length -= 15;
+    while (length >= 255) {
+      if (!Put(255)) {
+        return false;
+      }
+      length -= 255;
+    }
+    return Put(static_cast<uint8_t>(length));
+  }
+
+  auto PutBytes(const char *bytes, size_t length) -> bool {
+    if (capacity_ - size_ < length) {
+      return false;
+    }
+    memcpy(dst_ + size_, bytes, length);
+    size_ += length;
+    return true;
+  }
+
+  char *dst_;
+  size_t capacity_;
+  size_t size_{0};
+};
+
+}  // namespace
+
+auto LzUtil::Compress(const char *src, size_t size, char *dst, size_t capacity) -> size_t {
+  // the last position each hash of 4 bytes was seen at, plus one (0 means never)
+  std::array<uint32_t, 1 << HASH_BITS> table{};
+  Writer writer(dst, capacity);
+  size_t anchor = 0;
+  size_t pos = 0;
+  while (pos + MIN_MATCH <= size) {
+    uint32_t sequence = Load32(src + pos);
+    uint32_t &slot = table[Hash(sequence)];
+    size_t candidate = slot;
+    slot = static_cast<uint32_t>(pos + 1);
+    if (candidate == 0 || pos - (candidate - 1) > MAX_OFFSET || Load32(src + candidate - 1) != sequence) {
+      pos++;
+      continue;
+    }
+    size_t match = candidate - 1;
+    size_t length = MIN_MATCH;
+    while (pos + length < size && src[match + length] == src[pos + length]) {
+      length++;
+    }
+    if (!writer.WriteSequence(src + anchor, pos - anchor, pos - match, length)) {
+      return 0;
+    }
+    pos += length;
+    anchor = pos;
+  }
+  if (!writer.WriteSequence(src + anchor, size - anchor, 0, 0)) {
+    return 0;
+  }
+  return writer.Size();
+}
+
+auto LzUtil::Decompress(const char *src, size_t size, char *dst, size_t capacity) -> size_t {
+  const auto *in = reinterpret_cast<const uint8_t *>(src);
+  size_t ip = 0;
+  size_t op = 0;
+  // read the bytes extending a length, false if the input ends
+  auto read_length = [&](size_t *length) {
+    if (*length < 15) {
+      return true;
+    }
+    while (true) {
+      if (ip >= size) {
+        return false;
+      }
+      uint8_t byte = in[ip++];
+      *length += byte;
+      if (byte < 255) {
+        return true;
+      }
+    }
+  };
+  while (ip < size) {
+    uint8_t token = in[ip++];
+    size_t literal_length = token >> 4;
+    if (!read_length(&literal_length) || size - ip < literal_length || capacity - op < literal_length) {
+      return 0;
+    }
+    memcpy(dst + op, src + ip, literal_length);
+    ip += literal_length;
+    op += literal_length;
+    if (ip == size) {
+      break;
+    }
+    if (size - ip < 2) {
+      return 0;
+    }
+    size_t offset = in[ip] | (static_cast<size_t>(in[ip + 1]) << 8);
+    ip += 2;
+    size_t match_length = token & 15;
+    if (!read_length(&match_length)) {
+      return 0;
+    }
+    match_length += MIN_MATCH;
+    if (offset == 0 || offset > op || capacity - op < match_length) {
+      return 0;
+    }
+    // byte by byte, a match may overlap the bytes it produces
+    for (size_t i = 0; i < match_length; i++, op++) {
+      dst[op] = dst[op - offset];
+    }
+  }
+  return op;
+}
+
+}  // namespace bustub
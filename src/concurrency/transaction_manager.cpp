@@ -23,6 +23,14 @@
 namespace bustub {
 
 void TransactionManager::Commit(Transaction *txn) {
+  if (enable_logging) {
+    LogRecord record = LogRecord(txn->GetTransactionId(), txn->GetPrevLSN(), LogRecordType::COMMIT);
+    lsn_t lsn = log_manager_->AppendLogRecord(&record);
+    txn->SetPrevLSN(lsn);
+    // group commit: the commit record is flushed together with those of the concurrent commits
+    log_manager_->WaitForDurable(lsn);
+  }
+
   // Release all the locks.
   ReleaseLocks(txn);
 
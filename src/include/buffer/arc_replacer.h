@@ -0,0 +1,135 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// arc_replacer.h
+//
+// Identification: src/include/buffer/arc_replacer.h
+//
+// Copyright (c) 2015-2022, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#pragma once
+
+#include <list>
+#include <mutex>  // NOLINT
+#include <set>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+#include "buffer/replacer.h"
+#include "common/config.h"
+#include "common/macros.h"
+
+namespace bustub {
+
+/**
+ * ARCReplacer implements the Adaptive Replacement Cache policy (Megiddo & Modha, FAST '03).
+ *
+ * Resident frames live in one of two lists: T1 holds pages seen once since they were brought in, T2 holds pages seen
+ * at least twice. Evicted pages leave their page id behind in the ghost lists B1 (evicted from T1) and B2 (evicted from
+ * T2). A miss on a page remembered in B1 means T1 is too small and grows the target size p of T1; a miss on a page in
+ * B2 shrinks it. The victim comes from T1 while T1 is larger than p, from T2 otherwise, so the split between recency
+ * and frequency follows the workload without any tuning knob.
+ *
+ * Unlike the textbook version, pinned frames cannot be evicted: each list keeps its evictable frames in a set ordered
+ * by last access and the victim is the least recently used evictable frame of the chosen list.
+ */
+class ARCReplacer : public Replacer {
+ public:
+  /**
+   * @brief a new ARCReplacer.
+   * @param num_frames the maximum number of frames the replacer will be required to store, also the capacity c of ARC
+   */
+  explicit ARCReplacer(size_t num_frames);
+
+  DISALLOW_COPY_AND_MOVE(ARCReplacer);
+
+  ~ARCReplacer() override = default;
+
+  auto Evict(frame_id_t *frame_id) -> bool override;
+
+  /**
+   * @brief Record an access to the frame. A frame seen for the first time is placed in T2 if page_id is remembered by
+   * a ghost list (adapting the target size of T1), in T1 otherwise; a frame already in T1 is promoted to T2.
+   */
+  void RecordAccess(frame_id_t frame_id, AccessType access_type = AccessType::Unknown,
+                    page_id_t page_id = INVALID_PAGE_ID) override;
+
+  void SetEvictable(frame_id_t frame_id, bool set_evictable) override;
+
+  /**
+   * @brief Drop an evictable frame without remembering its page in a ghost list, the page is gone for good.
+   */
+  void Remove(frame_id_t frame_id) override;
+
+  auto Size() -> size_t override;
+
+  auto EvictionCandidates(size_t max_num) -> std::vector<frame_id_t> override;
+
+  /** @return the current target size of T1, exposed for tests. */
+  auto TargetT1Size() -> size_t;
+
+ private:
+  enum class ListId { None = 0, T1, T2 };
+
+  /** Ordering key of an evictable frame: (last access, frame id). */
+  using EvictKey = std::pair<size_t, frame_id_t>;
+
+  struct Node {
+    ListId list_{ListId::None};
+    bool evictable_{false};
+    size_t last_access_{0};
+    page_id_t page_id_{INVALID_PAGE_ID};
+  };
+
+  /** Page ids of recently evicted pages, the most recent in front. */
+  struct GhostList {
+    std::list<page_id_t> pages_;
+    std::unordered_map<page_id_t, std::list<page_id_t>::iterator> index_;
+
+    auto Contains(page_id_t page_id) const -> bool { return index_.count(page_id) != 0; }
+    void Push(page_id_t page_id) {
+      pages_.push_front(page_id);
+      index_[page_id] = pages_.begin();
+    }
+    void Erase(page_id_t page_id) {
+      auto it = index_.find(page_id);
+      if (it != index_.end()) {
+        pages_.erase(it->second);
+        index_.erase(it);
+      }
+    }
+    void PopBack() {
+      index_.erase(pages_.back());
+      pages_.pop_back();
+    }
+    auto Size() const -> size_t { return pages_.size(); }
+  };
+
+  auto EvictSetOf(ListId list) -> std::set<EvictKey> & { return list == ListId::T1 ? t1_evictable_ : t2_evictable_; }
+
+  /** @brief The list the next victim comes from, ListId::None if no frame is evictable. */
+  auto VictimList() -> ListId;
+
+  /** @brief Bound the ghost lists to |T1| + |B1| <= c and |T1| + |T2| + |B1| + |B2| <= 2c. */
+  void TrimGhosts();
+
+  std::vector<Node> nodes_;
+  std::set<EvictKey> t1_evictable_;
+  std::set<EvictKey> t2_evictable_;
+  /** Number of frames in T1 and T2, pinned or not. */
+  size_t t1_size_{0};
+  size_t t2_size_{0};
+  GhostList b1_;
+  GhostList b2_;
+  /** Target size of T1. */
+  size_t p_{0};
+  size_t current_timestamp_{0};
+  size_t replacer_size_;
+  std::mutex latch_;
+};
+
+}  // namespace bustub
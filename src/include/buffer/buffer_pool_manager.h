@@ -12,15 +12,24 @@
 
 #pragma once
 
+#include <future>  // NOLINT
+#include <condition_variable>  // NOLINT
+#include <deque>
 #include <list>
 #include <memory>
 #include <mutex>  // NOLINT
-#include <unordered_map>
+#include <thread>  // NOLINT
+#include <vector>
 
-#include "buffer/lru_k_replacer.h"
+#include "buffer/buffer_pool_stats.h"
+#include "buffer/frame_arena.h"
+#include "buffer/replacer.h"
+#include "buffer/page_table.h"
+#include "common/channel.h"
 #include "common/config.h"
 #include "recovery/log_manager.h"
 #include "storage/disk/disk_manager.h"
+#include "storage/disk/disk_scheduler.h"
 #include "storage/page/page.h"
 #include "storage/page/page_guard.h"
 
@@ -28,6 +37,20 @@ namespace bustub {
 
 /**
  * BufferPoolManager reads disk pages to and from its internal buffer pool.
+ *
+ * Pages fetched with AccessType::Scan are loaded into a scan ring of at most SCAN_RING_SIZE frames. Once the ring is
+ * full, a scan that misses recycles the oldest unpinned frame of the ring instead of evicting through the replacer, so
+ * a large sequential scan cannot push the working set of point accesses out of the pool. A ring frame that is
+ * accessed by anything but a scan leaves the ring and is managed by the replacer only.
+ *
+ * The frames of the pool are split into `num_instances` partitions. A page is always cached by the partition its id
+ * hashes to, and every partition has its own page table, free list, replacer and latch, so requests for pages that
+ * live in different partitions never contend with each other.
+ *
+ * Fetching or unpinning a page that is already in the pool takes no lock at all: the page table can be read without
+ * the partition latch and the frame is pinned with a compare-and-swap on its pin count. Before a frame is given to
+ * another page it is claimed by swapping its pin count from 0 to -1, which makes any concurrent lock-free pin fail.
+ * Accesses of lock-free hits are buffered and handed to the replacer the next time the partition latch is taken.
  */
 class BufferPoolManager {
  public:
@@ -37,9 +60,14 @@ class BufferPoolManager {
    * @param disk_manager the disk manager
    * @param replacer_k the lookback constant k for the LRU-K replacer
    * @param log_manager the log manager (for testing only: nullptr = disable logging). Please ignore this for P1.
+   * @param num_instances the number of partitions the frames are split into
+   * @param replacer_policy the replacement policy of every partition
+   * @param max_pool_size the largest size the pool can be resized to, 0 for pool_size. Memory for the frames is only
+   * reserved, not committed, up to this size.
    */
   BufferPoolManager(size_t pool_size, DiskManager *disk_manager, size_t replacer_k = LRUK_REPLACER_K,
-                    LogManager *log_manager = nullptr);
+                    LogManager *log_manager = nullptr, size_t num_instances = BUFFER_POOL_INSTANCES,
+                    ReplacerPolicy replacer_policy = ReplacerPolicy::LRUK, size_t max_pool_size = 0);
 
   /**
    * @brief Destroy an existing BufferPoolManager.
@@ -49,6 +77,27 @@ class BufferPoolManager {
   /** @brief Return the size (number of frames) of the buffer pool. */
   auto GetPoolSize() -> size_t { return pool_size_; }
 
+  /** @brief Return the largest size the buffer pool can be resized to. */
+  auto GetMaxPoolSize() -> size_t { return max_pool_size_; }
+
+  /** @brief Return the size of the pages in bytes, the page size of the database of the disk manager. */
+  auto GetPageSize() -> size_t { return page_size_; }
+
+  /**
+   * @brief Grow or shrink the buffer pool while it is in use. The frames in use are always [0, GetPoolSize()).
+   *
+   * Growing hands the new frames to the free lists of their partitions. Shrinking retires the frames from the top
+   * down: a retired frame's dirty page is written back, the page leaves the pool and the frame's memory is given back
+   * to the system. A pinned frame cannot be retired, so shrinking stops there and the pool keeps the frames below it.
+   *
+   * @param pool_size the new number of frames, between the number of partitions and GetMaxPoolSize()
+   * @return true if the pool has the requested size, false if it is out of range or shrinking hit a pinned frame
+   */
+  auto Resize(size_t pool_size) -> bool;
+
+  /** @brief Return the number of partitions of the buffer pool. */
+  auto GetNumInstances() -> size_t { return num_instances_; }
+
   /** @brief Return the pointer to all the pages in the buffer pool. */
   auto GetPages() -> Page * { return pages_; }
 
@@ -56,7 +105,7 @@ class BufferPoolManager {
    * TODO(P1): Add implementation
    *
    * @brief Create a new page in the buffer pool. Set page_id to the new page's id, or nullptr if all frames
-   * are currently in use and not evictable (in another word, pinned).
+   * of the partition that the new page id hashes to are currently in use and not evictable (in another word, pinned).
    *
    * You should pick the replacement frame from either the free list or the replacer (always find from the free list
    * first), and then call the AllocatePage() method to get a new page id. If the replacement frame has a dirty page,
@@ -66,10 +115,14 @@ class BufferPoolManager {
    * so that the replacer wouldn't evict the frame before the buffer pool manager "Unpin"s it.
    * Also, remember to record the access history of the frame in the replacer for the lru-k algorithm to work.
    *
+   * The new page is dirty even if it is never modified: its id may be a reused one whose old bytes are still on disk,
+   * so the zeroed page has to be written back before it is evicted.
+   *
    * @param[out] page_id id of created page
+   * @param segment the segment of the table or index the page belongs to, see DiskManager::AllocatePage()
    * @return nullptr if no new pages could be created, otherwise pointer to new page
    */
-  auto NewPage(page_id_t *page_id) -> Page *;
+  auto NewPage(page_id_t *page_id, page_id_t segment = INVALID_PAGE_ID) -> Page *;
 
   /**
    * TODO(P1): Add implementation
@@ -81,9 +134,10 @@ class BufferPoolManager {
    * BasicPageGuard structure.
    *
    * @param[out] page_id, the id of the new page
+   * @param segment the segment of the table or index the page belongs to, see DiskManager::AllocatePage()
    * @return BasicPageGuard holding a new page
    */
-  auto NewPageGuarded(page_id_t *page_id) -> BasicPageGuard;
+  auto NewPageGuarded(page_id_t *page_id, page_id_t segment = INVALID_PAGE_ID) -> BasicPageGuard;
 
   /**
    * TODO(P1): Add implementation
@@ -98,8 +152,11 @@ class BufferPoolManager {
    *
    * In addition, remember to disable eviction and record the access history of the frame like you did for NewPage().
    *
+   * A fetch with AccessType::Scan marks a sequential scan. When such a fetch misses, or hits a page loaded by
+   * read-ahead, the next READ_AHEAD_PAGES page ids are read into the pool asynchronously by the read-ahead thread.
+   *
    * @param page_id id of page to be fetched
-   * @param access_type type of access to the page, only needed for leaderboard tests.
+   * @param access_type type of access to the page, AccessType::Scan triggers read-ahead.
    * @return nullptr if page_id cannot be fetched, otherwise pointer to the requested page
    */
   auto FetchPage(page_id_t page_id, AccessType access_type = AccessType::Unknown) -> Page *;
@@ -115,11 +172,42 @@ class BufferPoolManager {
    * the returned page already has a read or write latch held, respectively.
    *
    * @param page_id, the id of the page to fetch
+   * @param access_type, type of access to the page, see FetchPage()
    * @return PageGuard holding the fetched page
    */
-  auto FetchPageBasic(page_id_t page_id) -> BasicPageGuard;
-  auto FetchPageRead(page_id_t page_id) -> ReadPageGuard;
-  auto FetchPageWrite(page_id_t page_id) -> WritePageGuard;
+  auto FetchPageBasic(page_id_t page_id, AccessType access_type = AccessType::Unknown) -> BasicPageGuard;
+  auto FetchPageRead(page_id_t page_id, AccessType access_type = AccessType::Unknown) -> ReadPageGuard;
+  auto FetchPageWrite(page_id_t page_id, AccessType access_type = AccessType::Unknown) -> WritePageGuard;
+
+  /**
+   * @brief Fetch a page with its upgrade latch held, see UpgradablePageGuard. The guard becomes a write guard with
+   * UpgradablePageGuard::Upgrade().
+   */
+  auto FetchPageUpgradable(page_id_t page_id, AccessType access_type = AccessType::Unknown) -> UpgradablePageGuard;
+
+  /**
+   * @brief Fetch a batch of pages, e.g. the leaf pages an index scan or a hash join probe will visit.
+   *
+   * The pages already in the pool are pinned in one lock-free pass. The misses are then grouped by partition, so
+   * every partition latch is taken once, and the reads of all of them are issued before waiting for any, letting the
+   * disk scheduler serve them in parallel. A page id may appear more than once, every occurrence gets its own pin.
+   *
+   * @param page_ids ids of the pages to fetch
+   * @param access_type type of access to the pages, see FetchPage()
+   * @return one guard per page id, in the order of page_ids; an empty vector if a page id is invalid or the pages do
+   * not fit in the pool at the same time, in which case no page stays pinned
+   */
+  auto FetchPages(const std::vector<page_id_t> &page_ids, AccessType access_type = AccessType::Unknown)
+      -> std::vector<BasicPageGuard>;
+
+  /**
+   * @brief Read a resident page optimistically, without pinning or latching it. See OptimisticPageGuard.
+   *
+   * @param page_id id of the page to read
+   * @return a guard on the page, or an invalid guard if the page is not in the pool or is being modified. The caller
+   * should then fall back to FetchPageRead().
+   */
+  auto FetchPageOptimistic(page_id_t page_id) -> OptimisticPageGuard;
 
   /**
    * TODO(P1): Add implementation
@@ -143,7 +231,8 @@ class BufferPoolManager {
    * @brief Flush the target page to disk.
    *
    * Use the DiskManager::WritePage() method to flush a page to disk, REGARDLESS of the dirty flag.
-   * Unset the dirty flag of the page after flushing.
+   * Unset the dirty flag of the page after flushing. The frame is pinned during the write, the partition latch is not
+   * held.
    *
    * @param page_id id of page to be flushed, cannot be INVALID_PAGE_ID
    * @return false if the page could not be found in the page table, true otherwise
@@ -151,9 +240,12 @@ class BufferPoolManager {
   auto FlushPage(page_id_t page_id) -> bool;
 
   /**
-   * TODO(P1): Add implementation
+   * @brief Flush all the dirty pages in the buffer pool to disk.
    *
-   * @brief Flush all the pages in the buffer pool to disk.
+   * The dirty pages are collected partition by partition, sorted by page id and written with one vectored write per
+   * run of consecutive page ids (at most FLUSH_BATCH_PAGES pages each). The partition latches are only held while
+   * collecting, fetches go on during the writes; a page being written is pinned and read latched, so it can be read
+   * but not modified until its run is on disk. The caller must not hold the latch of any page.
    */
   void FlushAllPages();
 
@@ -164,50 +256,236 @@ class BufferPoolManager {
    * page is pinned and cannot be deleted, return false immediately.
    *
    * After deleting the page from the page table, stop tracking the frame in the replacer and add the frame
-   * back to the free list. Also, reset the page's memory and metadata. Finally, you should call DeallocatePage() to
-   * imitate freeing the page on the disk.
+   * back to the free list. Also, reset the page's memory and metadata. Finally, call DeallocatePage() so the page id
+   * can be reused by NewPage(); a page that is not in the buffer pool is deallocated as well. A dirty page is dropped
+   * without being written back.
    *
    * @param page_id id of page to be deleted
    * @return false if the page exists but could not be deleted, true if the page didn't exist or deletion succeeded
    */
   auto DeletePage(page_id_t page_id) -> bool;
 
+  /**
+   * @brief Start the background flusher. Every `background_flush_interval`, or as soon as a dirty victim has to be
+   * written back in the foreground, the flusher walks the replacer's eviction order of every partition and writes
+   * back the dirty frames found there, until the next `clean_reserve` victims of the pool (counting free frames) are
+   * clean. Eviction of those frames then needs no write before the new page is read.
+   *
+   * The flusher is stopped when the buffer pool manager is destroyed.
+   *
+   * @param clean_reserve the number of clean evictable frames to keep across the pool
+   */
+  void StartBackgroundFlush(size_t clean_reserve);
+
+  /**
+   * @brief Take a snapshot of the counters of the buffer pool. The counters of the partitions are read one after the
+   * other while fetches go on, so the snapshot is not exact under concurrency.
+   */
+  auto GetStats() -> BufferPoolStats;
+
+  /** @brief Reset all the counters to zero. */
+  void ResetStats();
+
  private:
-  /** Number of pages in the buffer pool. */
-  const size_t pool_size_;
-  /** The next page id to be allocated  */
-  std::atomic<page_id_t> next_page_id_ = 0;
+  /**
+   * A partition of the buffer pool. Partition i owns the frames i, i + num_instances_, i + 2 * num_instances_, ...
+   * and caches exactly the pages whose id hashes to i.
+   */
+  struct BufferPoolInstance {
+    /** Index of this partition. */
+    size_t index_;
+    /** Page table for keeping track of the pages cached by this partition, readable without the latch. */
+    std::unique_ptr<PageTable> page_table_;
+    /** Replacer to find unpinned frames of this partition for replacement, it works on local frame ids. */
+    std::unique_ptr<Replacer> replacer_;
+    /** List of free frames of this partition that don't have any pages on them. */
+    std::list<frame_id_t> free_list_;
+    /** Frames holding pages loaded by scans, the oldest in front. */
+    std::deque<frame_id_t> scan_ring_;
+    /** Protects the page table, the free list and the book-keeping of all the frames owned by this partition. */
+    std::mutex latch_;
+
+    /** Capacity of the access buffer. */
+    static constexpr size_t ACCESS_BUFFER_SIZE = 64;
+    /**
+     * Frames hit by lock-free fetches, waiting to be recorded in the replacer. The buffer is lossy: when hits arrive
+     * faster than the partition latch is taken, the oldest ones are overwritten. An empty slot holds -1.
+     */
+    std::atomic<frame_id_t> access_buffer_[ACCESS_BUFFER_SIZE];
+    /** Number of accesses ever pushed into the buffer. */
+    std::atomic<size_t> access_write_{0};
+    /** Number of accesses already replayed, protected by the latch. */
+    size_t access_read_{0};
 
-  /** Array of buffer pool pages. */
+    /** Counters of this partition, see BufferPoolStats. They are updated with relaxed atomics. */
+    std::atomic<uint64_t> hits_[NUM_ACCESS_TYPES]{};
+    std::atomic<uint64_t> misses_[NUM_ACCESS_TYPES]{};
+    std::atomic<uint64_t> evictions_{0};
+    std::atomic<uint64_t> dirty_evictions_{0};
+    std::atomic<uint64_t> miss_latency_us_[MISS_LATENCY_BUCKETS]{};
+  };
+
+  /** Number of frames in use, frames [pool_size_, max_pool_size_) are retired. Protected by resize_latch_. */
+  std::atomic<size_t> pool_size_;
+  /** Number of frames reserved for resizing. */
+  const size_t max_pool_size_;
+  /** Serializes Resize(). */
+  std::mutex resize_latch_;
+  /** Number of partitions of the buffer pool. */
+  const size_t num_instances_;
+  /** Capacity of the scan ring of every partition. */
+  const size_t scan_ring_size_;
+  /** Size of a page, every frame holds one. */
+  const size_t page_size_;
+  /** Array of buffer pool pages, holds the metadata of the frames. */
   Page *pages_;
+  /** The data of all the frames, frame i is attached to pages_[i]. */
+  std::unique_ptr<FrameArena> arena_;
   /** Pointer to the disk manager. */
   DiskManager *disk_manager_ __attribute__((__unused__));
   /** Pointer to the log manager. Please ignore this for P1. */
   LogManager *log_manager_ __attribute__((__unused__));
-  /** Page table for keeping track of buffer pool pages. */
-  std::unordered_map<page_id_t, frame_id_t> page_table_;
-  /** Replacer to find unpinned pages for replacement. */
-  std::unique_ptr<LRUKReplacer> replacer_;
-  /** List of free frames that don't have any pages on them. */
-  std::list<frame_id_t> free_list_;
-  /** This latch protects shared data structures. We recommend updating this comment to describe what it protects. */
-  std::mutex latch_;
+  /** Pointer to the disk scheduler, all the page I/O of the buffer pool goes through it. */
+  std::unique_ptr<DiskScheduler> disk_scheduler_;
+  /** Partitions of the buffer pool. */
+  std::vector<std::unique_ptr<BufferPoolInstance>> instances_;
+
+  /** Number of clean evictable frames the background flusher keeps in every partition. */
+  size_t clean_reserve_{0};
+  std::atomic<bool> enable_background_flush_{false};
+  std::thread *background_flush_thread_{nullptr};
+  /** Used to wake up the background flusher early. */
+  std::mutex background_flush_latch_;
+  std::condition_variable background_flush_cv_;
+
+  /** Start page ids of the read-ahead windows requested by scans, `std::nullopt` stops the read-ahead thread. */
+  Channel<std::optional<page_id_t>> read_ahead_queue_;
+  std::thread *read_ahead_thread_{nullptr};
+
+  /** @brief Loop of the read-ahead thread. */
+  void RunReadAhead();
 
   /**
-   * @brief Allocate a page on disk. Caller should acquire the latch before calling this function.
+   * @brief Read the pages [first_page_id, first_page_id + READ_AHEAD_PAGES) that are allocated but not in the pool.
+   * All the reads are issued before waiting for any of them. The loaded pages are left unpinned and evictable.
+   */
+  void ReadAhead(page_id_t first_page_id);
+
+  /** @brief Loop of the background flusher thread. */
+  void RunBackgroundFlush();
+
+  /**
+   * @brief Write back the dirty frames among the next victims of the partition, so that at least clean_reserve_ of
+   * its free or evictable frames are clean. The frames are pinned and read latched while they are written, the
+   * partition latch is not held during the I/O.
+   */
+  void FlushColdPages(BufferPoolInstance &instance);
+
+  /**
+   * @brief Allocate a page on disk, reusing the ids of deallocated pages.
+   * @param segment the segment the page belongs to, INVALID_PAGE_ID for none
    * @return the id of the allocated page
    */
-  auto AllocatePage() -> page_id_t;
+  auto AllocatePage(page_id_t segment) -> page_id_t;
 
   /**
-   * @brief Deallocate a page on disk. Caller should acquire the latch before calling this function.
+   * @brief Deallocate a page on disk. Caller should acquire the latch of the page's partition before calling this
+   * function.
    * @param page_id id of the page to deallocate
    */
-  void DeallocatePage(__attribute__((unused)) page_id_t page_id) {
-    // This is a no-nop right now without a more complex data structure to track deallocated pages
+  void DeallocatePage(page_id_t page_id) { disk_manager_->DeallocatePage(page_id); }
+
+  /**
+   * @brief Schedule a read or write of the given page on the disk scheduler.
+   * @param is_write true for a write, false for a read
+   * @param page_id id of the page
+   * @param data the frame to read into / write from, must stay valid until the request is completed
+   * @return a future which becomes ready once the request is completed
+   */
+  auto ScheduleIo(bool is_write, page_id_t page_id, char *data) -> std::future<bool>;
+
+  /** @brief Return the partition which caches the given page. */
+  auto GetInstance(page_id_t page_id) -> BufferPoolInstance & { return *instances_[page_id % num_instances_]; }
+
+  /** @brief Convert between the global frame id and the local frame id used by the partition's replacer. */
+  auto ToLocalFrameId(frame_id_t frame_id) -> frame_id_t { return static_cast<frame_id_t>(frame_id / num_instances_); }
+  auto ToGlobalFrameId(const BufferPoolInstance &instance, frame_id_t local_frame_id) -> frame_id_t {
+    return static_cast<frame_id_t>(local_frame_id * num_instances_ + instance.index_);
   }
 
-  // TODO(student): You may add additional private members and helper functions
-  auto NewFrameUnlocked(frame_id_t &frame_id) -> Page *;
+  /**
+   * @brief Look up the frame caching the given page. If the frame is being filled or written back, wait until the
+   * I/O is done and look again. Caller should hold `lock` on the partition's latch.
+   * @return the frame id, or -1 if the page is not in the partition
+   */
+  auto FindFrame(std::unique_lock<std::mutex> &lock, BufferPoolInstance &instance, page_id_t page_id) -> frame_id_t;
+
+  /**
+   * @brief Take a frame from the free list or the replacer and reserve it for page_id. The reserved frame is pinned,
+   * mapped in the page table and marked as I/O in progress, so concurrent requests for page_id wait on it instead of
+   * loading the page again. Caller should hold `lock` on the partition's latch; the latch is released while a dirty
+   * victim is written back. The caller must clear the I/O flag and notify the frame once the page is ready.
+   * @param[out] frame_id id of the reserved frame
+   * @param access_type type of the access recorded in the replacer
+   * @return nullptr if all frames of the partition are pinned, otherwise the reserved (zeroed) frame
+   */
+  auto ReserveFrame(BufferPoolInstance &instance, std::unique_lock<std::mutex> &lock, page_id_t page_id,
+                    frame_id_t &frame_id, AccessType access_type = AccessType::Unknown) -> Page *;
+
+  /**
+   * @brief If the scan ring of the partition is full, take its oldest unpinned frame out of the ring and the replacer.
+   * Caller should hold the partition's latch.
+   * @return the frame id, or -1 if the ring is not full or all its frames are pinned
+   */
+  auto RecycleScanFrame(BufferPoolInstance &instance) -> frame_id_t;
+
+  /** @brief Remove the frame from the scan ring of the partition, if it is in there. */
+  void LeaveScanRing(BufferPoolInstance &instance, frame_id_t frame_id);
+
+  /**
+   * @brief Fetch a resident page without taking the partition latch.
+   * @return the pinned page, or nullptr if the page is not resident, is being loaded or evicted, or the access needs
+   * the partition latch (scan ring or read-ahead book-keeping). The caller then falls back to the locked path.
+   */
+  auto PinResidentPage(BufferPoolInstance &instance, page_id_t page_id, AccessType access_type) -> Page *;
+
+  /**
+   * @brief Pin a frame found in the page table and record the access. Caller should hold the partition's latch.
+   */
+  void PinFrame(BufferPoolInstance &instance, frame_id_t frame_id, AccessType access_type);
+
+  /** @brief Increment the pin count of the frame unless it is claimed for eviction. @return true if pinned */
+  auto TryPin(Page &page) -> bool;
+
+  /**
+   * @brief Swap the pin count of the frame from 0 to -1, so it cannot be pinned until it is given to another page.
+   * Caller should hold the partition's latch. @return true if the frame is claimed
+   */
+  auto TryClaimFrame(Page &page) -> bool;
+
+  /**
+   * @brief Decrement the pin count of the frame and make it evictable once it drops to 0.
+   * @return false if the frame was not pinned
+   */
+  auto UnpinFrame(BufferPoolInstance &instance, frame_id_t frame_id) -> bool;
+
+  /**
+   * @brief Write the frames of a run of consecutive pages with one vectored write, then release their read latches
+   * and pins and clear the run.
+   * @param first_page_id id of the page in run[0]
+   * @param run frames holding pages first_page_id, first_page_id + 1, ..., pinned and read latched
+   */
+  void WriteRun(page_id_t first_page_id, std::vector<frame_id_t> &run);
+
+  /**
+   * @brief Take a frame out of service: drop it from the free list, or evict the page it holds (writing it back if
+   * dirty). The retired frame stays claimed (pin count -1) until Resize() grows the pool again. Caller should hold
+   * the partition's latch.
+   * @return false if the frame is pinned or being loaded
+   */
+  auto RetireFrame(BufferPoolInstance &instance, frame_id_t frame_id) -> bool;
+
+  /** @brief Hand the accesses buffered by lock-free fetches to the replacer. Caller should hold the partition's latch. */
+  void DrainAccesses(BufferPoolInstance &instance);
 };
 }  // namespace bustub
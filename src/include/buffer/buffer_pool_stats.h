@@ -0,0 +1,67 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// buffer_pool_stats.h
+//
+// Identification: src/include/buffer/buffer_pool_stats.h
+//
+// Copyright (c) 2015-2023, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+
+#include "buffer/replacer.h"
+
+namespace bustub {
+
+/** Number of values of AccessType. */
+static constexpr size_t NUM_ACCESS_TYPES = 3;
+/** Number of buckets of the miss latency histogram. */
+static constexpr size_t MISS_LATENCY_BUCKETS = 24;
+
+/**
+ * A snapshot of the counters of a buffer pool manager, see BufferPoolManager::GetStats().
+ *
+ * Bucket 0 of the miss latency histogram counts the misses served in less than 1us, bucket i > 0 those that took
+ * [2^(i-1), 2^i) microseconds, and the last bucket everything slower.
+ */
+struct BufferPoolStats {
+  /** Fetches of resident pages, indexed by AccessType. */
+  uint64_t hits_[NUM_ACCESS_TYPES]{};
+  /** Fetches that had to load the page, indexed by AccessType. */
+  uint64_t misses_[NUM_ACCESS_TYPES]{};
+  /** Pages evicted to make room for another page. */
+  uint64_t evictions_{0};
+  /** Evicted pages that had to be written back first. */
+  uint64_t dirty_evictions_{0};
+  /** Histogram of the time spent in FetchPage by misses. */
+  uint64_t miss_latency_us_[MISS_LATENCY_BUCKETS]{};
+  /** Frames in the free lists at the time of the snapshot. */
+  size_t free_frames_{0};
+
+  /** @return the histogram bucket of a miss that took latency_us microseconds */
+  static auto LatencyBucket(uint64_t latency_us) -> size_t;
+
+  /** @return the name of the access type */
+  static auto AccessTypeName(AccessType access_type) -> const char *;
+
+  /** @return hits / (hits + misses) over all access types, 0 if there was no fetch */
+  auto HitRatio() const -> double;
+
+  /**
+   * @return an upper bound of the given percentile (0 - 100) of the miss latency in microseconds, i.e. the upper bound
+   * of the histogram bucket it falls into, 0 if there was no miss
+   */
+  auto MissLatencyPercentile(double percentile) const -> uint64_t;
+
+  /** @return a multi-line human readable summary */
+  auto ToString() const -> std::string;
+};
+
+}  // namespace bustub
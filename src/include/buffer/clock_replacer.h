@@ -12,17 +12,21 @@
 
 #pragma once
 
-#include <list>
 #include <mutex>  // NOLINT
 #include <vector>
 
 #include "buffer/replacer.h"
 #include "common/config.h"
+#include "common/macros.h"
 
 namespace bustub {
 
 /**
  * ClockReplacer implements the clock replacement policy, which approximates the Least Recently Used policy.
+ *
+ * Every tracked frame carries a reference bit that is set on each access. The hand sweeps the frames in id order;
+ * an evictable frame with its reference bit set gets a second chance (the bit is cleared), the first evictable frame
+ * found with a clear bit is the victim.
  */
 class ClockReplacer : public Replacer {
  public:
@@ -32,21 +36,42 @@ class ClockReplacer : public Replacer {
    */
   explicit ClockReplacer(size_t num_pages);
 
+  DISALLOW_COPY_AND_MOVE(ClockReplacer);
+
   /**
    * Destroys the ClockReplacer.
    */
   ~ClockReplacer() override;
 
-  auto Victim(frame_id_t *frame_id) -> bool override;
+  auto Evict(frame_id_t *frame_id) -> bool override;
+
+  void RecordAccess(frame_id_t frame_id, AccessType access_type = AccessType::Unknown,
+                    page_id_t page_id = INVALID_PAGE_ID) override;
 
-  void Pin(frame_id_t frame_id) override;
+  void SetEvictable(frame_id_t frame_id, bool set_evictable) override;
 
-  void Unpin(frame_id_t frame_id) override;
+  void Remove(frame_id_t frame_id) override;
 
   auto Size() -> size_t override;
 
+  /**
+   * @brief Return the evictable frames in the order the hand would evict them: first the frames whose reference bit
+   * is clear, then the ones that would get a second chance.
+   */
+  auto EvictionCandidates(size_t max_num) -> std::vector<frame_id_t> override;
+
  private:
-  // TODO(student): implement me!
+  struct Slot {
+    bool tracked_{false};
+    bool evictable_{false};
+    bool referenced_{false};
+  };
+
+  std::vector<Slot> slots_;
+  /** Next frame the hand looks at. */
+  size_t hand_{0};
+  size_t curr_size_{0};
+  std::mutex latch_;
 };
 
 }  // namespace bustub
@@ -0,0 +1,76 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// frame_arena.h
+//
+// Identification: src/include/buffer/frame_arena.h
+//
+// Copyright (c) 2015-2023, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#pragma once
+
+#include <cstddef>
+
+#include "common/config.h"
+#include "common/macros.h"
+
+namespace bustub {
+
+/**
+ * FrameArena holds the data of all the frames of a buffer pool in one contiguous, page-aligned region mapped with
+ * mmap. Frame i starts at a multiple of the page size, so pages can be read and written with O_DIRECT straight
+ * into the frames. The region can optionally be backed by huge pages to reduce TLB misses: explicit huge pages are
+ * tried first and transparent huge pages are requested otherwise.
+ *
+ * The mapping is only reserved: physical memory is committed when a frame is first touched, and Release() gives the
+ * memory of an unused frame back to the system, so an arena can be sized for the largest pool it may ever hold.
+ *
+ * When built with AddressSanitizer, every frame is followed by a poisoned guard page, so that an access past the end
+ * of a page is still reported.
+ */
+class FrameArena {
+ public:
+  /**
+   * @brief Map the memory of the arena, zeroed.
+   * @param num_frames the number of frames
+   * @param use_huge_pages whether to back the arena with huge pages if the system supports it
+   * @param page_size the size of a frame, a power of two of at least BUSTUB_PAGE_SIZE
+   */
+  FrameArena(size_t num_frames, bool use_huge_pages, size_t page_size = BUSTUB_PAGE_SIZE);
+
+  DISALLOW_COPY_AND_MOVE(FrameArena);
+
+  /** @brief Unmap the memory of the arena. */
+  ~FrameArena();
+
+  /** @return the data of the given frame */
+  auto GetFrame(size_t frame_idx) -> char * { return memory_ + frame_idx * frame_stride_; }
+
+  /**
+   * @brief Give the memory of a frame that is no longer used back to the system. The frame reads as zeroes
+   * afterwards either way: a frame backed by explicit huge pages cannot be given back and is cleared instead.
+   * @return true if the memory was given back to the system
+   */
+  auto Release(size_t frame_idx) -> bool;
+
+  /** @return true if the arena is backed by explicit or transparent huge pages */
+  auto UsesHugePages() const -> bool { return huge_pages_; }
+
+ private:
+  /** The number of frames in the arena. */
+  size_t num_frames_;
+  /** The size of a frame. */
+  size_t page_size_;
+  /** Distance in bytes between the starts of two consecutive frames. */
+  size_t frame_stride_;
+  /** The size of the mapping in bytes. */
+  size_t size_;
+  /** Start of the mapping. */
+  char *memory_{nullptr};
+  bool huge_pages_{false};
+};
+
+}  // namespace bustub
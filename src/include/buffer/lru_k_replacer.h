@@ -15,25 +15,26 @@
 #include <limits>
 #include <list>
 #include <mutex>  // NOLINT
+#include <set>
 #include <unordered_map>
+#include <utility>
 #include <vector>
 
+#include "buffer/replacer.h"
 #include "common/config.h"
 #include "common/macros.h"
 
 namespace bustub {
 
-enum class AccessType { Unknown = 0, Get, Scan };
-
 class LRUKNode {
  private:
   /** History of last seen K timestamps of this page. Least recent timestamp stored in front. */
   // Remove maybe_unused if you start using them. Feel free to change the member variables as you want.
   friend class LRUKReplacer;
-  [[maybe_unused]] std::list<size_t> history_;
-  [[maybe_unused]] size_t k_;
-  [[maybe_unused]] frame_id_t fid_;
-  [[maybe_unused]] bool is_evictable_{false};
+  std::list<size_t> history_;
+  size_t k_;
+  frame_id_t fid_;
+  bool is_evictable_{false};
 };
 
 /**
@@ -46,8 +47,13 @@ class LRUKNode {
  * A frame with less than k historical references is given
  * +inf as its backward k-distance. When multipe frames have +inf backward k-distance,
  * classical LRU algorithm is used to choose victim.
+ *
+ * Evictable frames are kept in two ordered sets keyed by the oldest timestamp in their history: one for the frames
+ * with less than k references (ordered by their earliest access) and one for the frames with a full history
+ * (ordered by their kth previous access). The victim is always the first element of the first non-empty set, so
+ * every operation costs O(log n) regardless of the number of frames.
  */
-class LRUKReplacer {
+class LRUKReplacer : public Replacer {
  public:
   /**
    *
@@ -65,7 +71,7 @@ class LRUKReplacer {
    *
    * @brief Destroys the LRUReplacer.
    */
-  ~LRUKReplacer() = default;
+  ~LRUKReplacer() override = default;
 
   /**
    * TODO(P1): Add implementation
@@ -83,7 +89,7 @@ class LRUKReplacer {
    * @param[out] frame_id id of frame that is evicted.
    * @return true if a frame is evicted successfully, false if no frames can be evicted.
    */
-  auto Evict(frame_id_t *frame_id) -> bool;
+  auto Evict(frame_id_t *frame_id) -> bool override;
 
   /**
    * TODO(P1): Add implementation
@@ -97,8 +103,10 @@ class LRUKReplacer {
    * @param frame_id id of frame that received a new access.
    * @param access_type type of access that was received. This parameter is only needed for
    * leaderboard tests.
+   * @param page_id unused, LRU-K does not remember evicted pages.
    */
-  void RecordAccess(frame_id_t frame_id, AccessType access_type = AccessType::Unknown);
+  void RecordAccess(frame_id_t frame_id, AccessType access_type = AccessType::Unknown,
+                    page_id_t page_id = INVALID_PAGE_ID) override;
 
   /**
    * TODO(P1): Add implementation
@@ -112,12 +120,13 @@ class LRUKReplacer {
    *
    * If frame id is invalid, throw an exception or abort the process.
    *
-   * For other scenarios, this function should terminate without modifying anything.
+   * For other scenarios, e.g. a frame that is not tracked, this function should terminate without modifying
+   * anything.
    *
    * @param frame_id id of frame whose 'evictable' status will be modified
    * @param set_evictable whether the given frame is evictable or not
    */
-  void SetEvictable(frame_id_t frame_id, bool set_evictable);
+  void SetEvictable(frame_id_t frame_id, bool set_evictable) override;
 
   /**
    * TODO(P1): Add implementation
@@ -136,7 +145,7 @@ class LRUKReplacer {
    *
    * @param frame_id id of frame to be removed
    */
-  void Remove(frame_id_t frame_id);
+  void Remove(frame_id_t frame_id) override;
 
   /**
    * TODO(P1): Add implementation
@@ -145,17 +154,37 @@ class LRUKReplacer {
    *
    * @return size_t
    */
-  auto Size() -> size_t;
+  auto Size() -> size_t override;
+
+  /**
+   * @brief Return the evictable frames in the order they would be evicted, without evicting them.
+   *
+   * @param max_num the maximum number of frames to return
+   * @return at most max_num frame ids, the next victim first
+   */
+  auto EvictionCandidates(size_t max_num) -> std::vector<frame_id_t> override;
 
  private:
+  /** Ordering key of an evictable frame: the oldest timestamp in its history, unique across frames. */
+  using EvictKey = std::pair<size_t, frame_id_t>;
+
+  /** @brief Return the set that holds the node while it is evictable. */
+  auto EvictSetOf(const LRUKNode &node) -> std::set<EvictKey> & {
+    return node.history_.size() < node.k_ ? less_k_frames_ : k_frames_;
+  }
+
   // TODO(student): implement me! You can replace these member variables as you like.
   // Remove maybe_unused if you start using them.
-  [[maybe_unused]] std::unordered_map<frame_id_t, LRUKNode> node_store_;
-  [[maybe_unused]] size_t current_timestamp_{0};
-  [[maybe_unused]] size_t curr_size_{0};
-  [[maybe_unused]] size_t replacer_size_;
-  [[maybe_unused]] size_t k_;
-  [[maybe_unused]] std::mutex latch_;
+  std::unordered_map<frame_id_t, LRUKNode> node_store_;
+  /** Evictable frames with less than k references, the front one has the earliest first access. */
+  std::set<EvictKey> less_k_frames_;
+  /** Evictable frames with k references, the front one has the largest backward k-distance. */
+  std::set<EvictKey> k_frames_;
+  size_t current_timestamp_{0};
+  size_t curr_size_{0};
+  size_t replacer_size_;
+  size_t k_;
+  std::mutex latch_;
 };
 
 }  // namespace bustub
@@ -12,17 +12,21 @@
 
 #pragma once
 
-#include <list>
 #include <mutex>  // NOLINT
+#include <set>
+#include <utility>
 #include <vector>
 
 #include "buffer/replacer.h"
 #include "common/config.h"
+#include "common/macros.h"
 
 namespace bustub {
 
 /**
- * LRUReplacer implements the Least Recently Used replacement policy.
+ * LRUReplacer implements the Least Recently Used replacement policy: the victim is the evictable frame whose last
+ * access is the oldest. Evictable frames are kept in a set ordered by their last access, so every operation costs
+ * O(log n).
  */
 class LRUReplacer : public Replacer {
  public:
@@ -32,21 +36,39 @@ class LRUReplacer : public Replacer {
    */
   explicit LRUReplacer(size_t num_pages);
 
+  DISALLOW_COPY_AND_MOVE(LRUReplacer);
+
   /**
    * Destroys the LRUReplacer.
    */
   ~LRUReplacer() override;
 
-  auto Victim(frame_id_t *frame_id) -> bool override;
+  auto Evict(frame_id_t *frame_id) -> bool override;
+
+  void RecordAccess(frame_id_t frame_id, AccessType access_type = AccessType::Unknown,
+                    page_id_t page_id = INVALID_PAGE_ID) override;
 
-  void Pin(frame_id_t frame_id) override;
+  void SetEvictable(frame_id_t frame_id, bool set_evictable) override;
 
-  void Unpin(frame_id_t frame_id) override;
+  void Remove(frame_id_t frame_id) override;
 
   auto Size() -> size_t override;
 
+  auto EvictionCandidates(size_t max_num) -> std::vector<frame_id_t> override;
+
  private:
-  // TODO(student): implement me!
+  struct Node {
+    bool tracked_{false};
+    bool evictable_{false};
+    size_t last_access_{0};
+  };
+
+  /** Node of every frame, indexed by frame id. */
+  std::vector<Node> nodes_;
+  /** Evictable frames ordered by (last access, frame id), the victim first. */
+  std::set<std::pair<size_t, frame_id_t>> evictable_;
+  size_t current_timestamp_{0};
+  std::mutex latch_;
 };
 
 }  // namespace bustub
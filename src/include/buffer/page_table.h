@@ -0,0 +1,106 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// page_table.h
+//
+// Identification: src/include/buffer/page_table.h
+//
+// Copyright (c) 2015-2023, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+#include <memory>
+
+#include "common/config.h"
+#include "common/macros.h"
+
+namespace bustub {
+
+/**
+ * PageTable maps page ids to frame ids for one partition of the buffer pool.
+ *
+ * It is an open-addressing hash table with linear probing over a fixed array of 64-bit atomic slots, each packing a
+ * (page_id, frame_id) pair. Find() takes no lock and may be called at any time. Insert() and Erase() must be
+ * serialized by the caller (the buffer pool holds the partition latch). Erase() shifts the following entries of the
+ * probe sequence back instead of leaving tombstones, so a concurrent Find() may miss an entry while it is being
+ * moved; it never returns a pair that was not in the table at some point. Lock-free readers must therefore validate
+ * the frame they found and fall back to a locked lookup on a miss.
+ */
+class PageTable {
+ public:
+  /**
+   * @brief Create a table that can hold up to max_entries mappings.
+   * @param max_entries maximum number of mappings present at the same time
+   */
+  explicit PageTable(size_t max_entries);
+
+  DISALLOW_COPY_AND_MOVE(PageTable);
+
+  ~PageTable() = default;
+
+  /**
+   * @brief Look up the frame of the given page. Lock-free.
+   * @return the frame id, or -1 if the page was not found
+   */
+  auto Find(page_id_t page_id) const -> frame_id_t;
+
+  /**
+   * @brief Map page_id to frame_id, replacing the previous mapping of page_id. Writers must be serialized.
+   */
+  void Insert(page_id_t page_id, frame_id_t frame_id);
+
+  /**
+   * @brief Remove the mapping of page_id. Writers must be serialized.
+   * @return true if the page was in the table
+   */
+  auto Erase(page_id_t page_id) -> bool;
+
+  /** @return the number of mappings. Only exact when writers are excluded. */
+  auto Size() const -> size_t { return size_; }
+
+  /**
+   * @brief Call f(page_id, frame_id) for every mapping. Writers must be excluded while iterating.
+   */
+  template <typename F>
+  void ForEach(F &&f) const {
+    for (size_t i = 0; i <= mask_; ++i) {
+      uint64_t slot = slots_[i].load();
+      if (slot != EMPTY_SLOT) {
+        f(PageIdOf(slot), FrameIdOf(slot));
+      }
+    }
+  }
+
+ private:
+  /** A slot holding INVALID_PAGE_ID is empty. */
+  static constexpr uint64_t EMPTY_SLOT = ~static_cast<uint64_t>(0);
+
+  static auto Pack(page_id_t page_id, frame_id_t frame_id) -> uint64_t {
+    return (static_cast<uint64_t>(static_cast<uint32_t>(page_id)) << 32) | static_cast<uint32_t>(frame_id);
+  }
+  static auto PageIdOf(uint64_t slot) -> page_id_t { return static_cast<page_id_t>(slot >> 32); }
+  static auto FrameIdOf(uint64_t slot) -> frame_id_t { return static_cast<frame_id_t>(slot & 0xFFFFFFFF); }
+
+  /** @return the slot where the probe sequence of page_id starts. */
+  auto HomeOf(page_id_t page_id) const -> size_t {
+    // Fibonacci hashing, page ids of a partition are equal modulo the number of partitions
+    return static_cast<size_t>((static_cast<uint64_t>(static_cast<uint32_t>(page_id)) * 0x9E3779B97F4A7C15ULL) >>
+                               shift_);
+  }
+
+  /** The slots, the size of the array is a power of two. */
+  std::unique_ptr<std::atomic<uint64_t>[]> slots_;
+  /** Number of slots minus one. */
+  size_t mask_;
+  /** 64 - log2(number of slots). */
+  int shift_;
+  /** Number of mappings. */
+  size_t size_{0};
+};
+
+}  // namespace bustub
@@ -12,12 +12,25 @@
 
 #pragma once
 
+#include <memory>
+#include <string>
+#include <vector>
+
 #include "common/config.h"
 
 namespace bustub {
 
+enum class AccessType { Unknown = 0, Get, Scan };
+
+/** The replacement policies the buffer pool manager can be configured with, see MakeReplacer(). */
+enum class ReplacerPolicy { LRU = 0, Clock, LRUK, ARC, TwoQ };
+
 /**
- * Replacer is an abstract class that tracks page usage.
+ * Replacer is an abstract class that tracks frame usage and picks the frame to evict.
+ *
+ * A frame is tracked from its first recorded access until it is evicted or removed, and starts out non-evictable.
+ * Only evictable frames are candidates for eviction. Frame ids must be smaller than the number of frames the
+ * replacer was created with. Implementations are thread-safe.
  */
 class Replacer {
  public:
@@ -25,26 +38,61 @@ class Replacer {
   virtual ~Replacer() = default;
 
   /**
-   * Remove the victim frame as defined by the replacement policy.
-   * @param[out] frame_id id of frame that was removed, nullptr if no victim was found
-   * @return true if a victim frame was found, false otherwise
+   * @brief Evict the victim frame as defined by the replacement policy, and stop tracking it.
+   * @param[out] frame_id id of the evicted frame
+   * @return true if a frame was evicted, false if no frame is evictable
    */
-  virtual auto Victim(frame_id_t *frame_id) -> bool = 0;
+  virtual auto Evict(frame_id_t *frame_id) -> bool = 0;
 
   /**
-   * Pins a frame, indicating that it should not be victimized until it is unpinned.
-   * @param frame_id the id of the frame to pin
+   * @brief Record an access to the given frame, and start tracking the frame if it is not tracked yet.
+   * @param frame_id id of the accessed frame
+   * @param access_type type of the access
+   * @param page_id the page held by the frame. Policies that remember evicted pages need it on the first access of
+   * a frame, INVALID_PAGE_ID is treated as a page that was never seen.
    */
-  virtual void Pin(frame_id_t frame_id) = 0;
+  virtual void RecordAccess(frame_id_t frame_id, AccessType access_type = AccessType::Unknown,
+                            page_id_t page_id = INVALID_PAGE_ID) = 0;
 
   /**
-   * Unpins a frame, indicating that it can now be victimized.
-   * @param frame_id the id of the frame to unpin
+   * @brief Toggle whether a tracked frame is evictable. Does nothing if the frame is not tracked: the buffer pool
+   * unpins without its latch, so an unpin can reach the replacer after the frame was evicted and before it is tracked
+   * again.
+   * @param frame_id id of the frame
+   * @param set_evictable whether the frame is evictable
    */
-  virtual void Unpin(frame_id_t frame_id) = 0;
+  virtual void SetEvictable(frame_id_t frame_id, bool set_evictable) = 0;
 
-  /** @return the number of elements in the replacer that can be victimized */
+  /**
+   * @brief Stop tracking an evictable frame, no matter where it stands in the eviction order. Does nothing if the
+   * frame is not tracked, aborts if it is not evictable.
+   * @param frame_id id of the frame
+   */
+  virtual void Remove(frame_id_t frame_id) = 0;
+
+  /** @return the number of evictable frames */
   virtual auto Size() -> size_t = 0;
+
+  /**
+   * @brief Return the evictable frames in the order they would be evicted, without evicting them.
+   * @param max_num the maximum number of frames to return
+   * @return at most max_num frame ids, the next victim first
+   */
+  virtual auto EvictionCandidates(size_t max_num) -> std::vector<frame_id_t> = 0;
 };
 
+/**
+ * @brief Create a replacer.
+ * @param policy the replacement policy
+ * @param num_frames the number of frames the replacer tracks
+ * @param k the lookback constant, only used by ReplacerPolicy::LRUK
+ */
+auto MakeReplacer(ReplacerPolicy policy, size_t num_frames, size_t k) -> std::unique_ptr<Replacer>;
+
+/** @return the name of the policy, as accepted by ParseReplacerPolicy() */
+auto ReplacerPolicyToString(ReplacerPolicy policy) -> std::string;
+
+/** @brief Parse "lru", "clock", "lru-k", "arc" or "2q". Throws an Exception on other names. */
+auto ParseReplacerPolicy(const std::string &name) -> ReplacerPolicy;
+
 }  // namespace bustub
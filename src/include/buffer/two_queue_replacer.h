@@ -0,0 +1,104 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// two_queue_replacer.h
+//
+// Identification: src/include/buffer/two_queue_replacer.h
+//
+// Copyright (c) 2015-2022, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#pragma once
+
+#include <list>
+#include <mutex>  // NOLINT
+#include <set>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+#include "buffer/replacer.h"
+#include "common/config.h"
+#include "common/macros.h"
+
+namespace bustub {
+
+/**
+ * TwoQueueReplacer implements the full version of the 2Q policy (Johnson & Shasha, VLDB '94).
+ *
+ * A page brought in for the first time enters A1in, a FIFO of at most Kin = c / 4 frames, and further hits there do
+ * not reorder it, so a burst of correlated references is absorbed without promoting the page. When a page leaves
+ * A1in its id is remembered in the ghost FIFO A1out (Kout = c / 2 entries); a page that is referenced again while it
+ * is in A1out has proven it is hot and goes to Am, a plain LRU list. Pages touched once, such as a sequential scan,
+ * therefore only ever cycle through A1in.
+ */
+class TwoQueueReplacer : public Replacer {
+ public:
+  /**
+   * @brief a new TwoQueueReplacer.
+   * @param num_frames the maximum number of frames the replacer will be required to store
+   */
+  explicit TwoQueueReplacer(size_t num_frames);
+
+  DISALLOW_COPY_AND_MOVE(TwoQueueReplacer);
+
+  ~TwoQueueReplacer() override = default;
+
+  auto Evict(frame_id_t *frame_id) -> bool override;
+
+  /**
+   * @brief Record an access to the frame. A frame seen for the first time goes to Am if page_id is remembered by
+   * A1out, to A1in otherwise; a frame in Am is moved to the most recently used end.
+   */
+  void RecordAccess(frame_id_t frame_id, AccessType access_type = AccessType::Unknown,
+                    page_id_t page_id = INVALID_PAGE_ID) override;
+
+  void SetEvictable(frame_id_t frame_id, bool set_evictable) override;
+
+  /**
+   * @brief Drop an evictable frame without remembering its page in A1out, the page is gone for good.
+   */
+  void Remove(frame_id_t frame_id) override;
+
+  auto Size() -> size_t override;
+
+  auto EvictionCandidates(size_t max_num) -> std::vector<frame_id_t> override;
+
+ private:
+  enum class QueueId { None = 0, A1in, Am };
+
+  /** Ordering key of an evictable frame: (entry time for A1in, last access for Am, frame id). */
+  using EvictKey = std::pair<size_t, frame_id_t>;
+
+  struct Node {
+    QueueId queue_{QueueId::None};
+    bool evictable_{false};
+    size_t timestamp_{0};
+    page_id_t page_id_{INVALID_PAGE_ID};
+  };
+
+  auto EvictSetOf(QueueId queue) -> std::set<EvictKey> & {
+    return queue == QueueId::A1in ? a1in_evictable_ : am_evictable_;
+  }
+
+  /** @brief The queue the next victim comes from, QueueId::None if no frame is evictable. */
+  auto VictimQueue() -> QueueId;
+
+  std::vector<Node> nodes_;
+  std::set<EvictKey> a1in_evictable_;
+  std::set<EvictKey> am_evictable_;
+  /** Number of frames in A1in, pinned or not. */
+  size_t a1in_size_{0};
+  /** Page ids evicted from A1in, the most recent in front. */
+  std::list<page_id_t> a1out_;
+  std::unordered_map<page_id_t, std::list<page_id_t>::iterator> a1out_index_;
+  size_t kin_;
+  size_t kout_;
+  size_t current_timestamp_{0};
+  size_t replacer_size_;
+  std::mutex latch_;
+};
+
+}  // namespace bustub
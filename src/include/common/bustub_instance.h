@@ -210,6 +210,19 @@ class FortTableWriter : public ResultWriter {
   std::vector<std::string> tables_;
 };
 
+/** How a file-backed BustubInstance reads and writes its database file. */
+enum class DiskBackend {
+  /** pread / pwrite through the page cache */
+  Pread,
+  /** pread / pwrite with O_DIRECT, bypassing the page cache */
+  DirectIo,
+  /** batches of the disk scheduler submitted through io_uring with O_DIRECT, pread / pwrite if io_uring is
+     unavailable */
+  IoUring,
+  /** pages compressed on disk, see DiskManagerCompressed */
+  Compressed,
+};
+
 class BustubInstance {
  private:
   /**
@@ -218,7 +231,13 @@ class BustubInstance {
   auto MakeExecutorContext(Transaction *txn, bool is_modify) -> std::unique_ptr<ExecutorContext>;
 
  public:
-  explicit BustubInstance(const std::string &db_file_name);
+  /**
+   * Open or create a database file.
+   * @param page_size the page size of the database if the file is created, an existing file keeps its page size
+   * @param disk_backend how the database file is read and written
+   */
+  explicit BustubInstance(const std::string &db_file_name, size_t page_size = BUSTUB_PAGE_SIZE,
+                          DiskBackend disk_backend = DiskBackend::Pread);
 
   BustubInstance();
 
@@ -279,6 +298,7 @@ class BustubInstance {
   void CmdDisplayTables(ResultWriter &writer);
   void CmdDisplayIndices(ResultWriter &writer);
   void CmdDisplayHelp(ResultWriter &writer);
+  void CmdDisplayBufferPoolStats(ResultWriter &writer);
   void WriteOneCell(const std::string &cell, ResultWriter &writer);
 
   void HandleCreateStatement(Transaction *txn, const CreateStatement &stmt, ResultWriter &writer);
@@ -286,6 +306,7 @@ class BustubInstance {
   void HandleExplainStatement(Transaction *txn, const ExplainStatement &stmt, ResultWriter &writer);
   void HandleVariableShowStatement(Transaction *txn, const VariableShowStatement &stmt, ResultWriter &writer);
   void HandleVariableSetStatement(Transaction *txn, const VariableSetStatement &stmt, ResultWriter &writer);
+  void ResizeBufferPool(const std::string &value);
 
   std::unordered_map<std::string, std::string> session_variables_;
 };
@@ -21,18 +21,38 @@ namespace bustub {
 /** Cycle detection is performed every CYCLE_DETECTION_INTERVAL milliseconds. */
 extern std::chrono::milliseconds cycle_detection_interval;
 
+/** The background flusher of the buffer pool writes back cold dirty pages every BACKGROUND_FLUSH_INTERVAL. */
+extern std::chrono::milliseconds background_flush_interval;
+
 /** True if logging should be enabled, false otherwise. */
 extern std::atomic<bool> enable_logging;
 
+/** If ENABLE_HUGE_PAGES is true, buffer pools created afterwards back their frames with huge pages when possible. */
+extern std::atomic<bool> enable_huge_pages;
+
 /** If ENABLE_LOGGING is true, the log should be flushed to disk every LOG_TIMEOUT. */
 extern std::chrono::duration<int64_t> log_timeout;
 
 static constexpr int INVALID_PAGE_ID = -1;                                           // invalid page id
+static constexpr int NEW_SEGMENT = -2;                                               // segment of a new table or index
 static constexpr int INVALID_TXN_ID = -1;                                            // invalid transaction id
 static constexpr int INVALID_LSN = -1;                                               // invalid log sequence number
 static constexpr int HEADER_PAGE_ID = 0;                                             // the header page id
-static constexpr int BUSTUB_PAGE_SIZE = 4096;                                        // size of a data page in byte
+static constexpr int BUSTUB_PAGE_SIZE = 4096;                                        // default and smallest page size in byte
+static constexpr int BUSTUB_MAX_PAGE_SIZE = 65536;                                   // largest page size of a database
+static constexpr int CACHE_LINE_SIZE = 64;                                           // size of a cpu cache line
 static constexpr int BUFFER_POOL_SIZE = 10;                                          // size of buffer pool
+static constexpr int BUFFER_POOL_INSTANCES = 1;                                      // partitions of buffer pool
+static constexpr int BUFFER_POOL_MAX_SIZE = 16384;                                   // frames reserved for resizing the instance pool
+static constexpr int BACKGROUND_FLUSH_RESERVE = 16;                                  // clean frames kept by flusher
+static constexpr int READ_AHEAD_PAGES = 8;                                           // pages prefetched by scans
+static constexpr int EXTENT_SIZE = 64;                                               // pages per extent of a segment
+static constexpr int SCAN_RING_SIZE = 16;                                            // frames recycled by scans
+static constexpr int OPTIMISTIC_ACCESS_SAMPLE = 16;                                  // optimistic reads per recorded access
+static constexpr int OPTIMISTIC_DESCENT_ATTEMPTS = 3;                                // optimistic b+ tree descents before latching
+static constexpr int FLUSH_BATCH_PAGES = 64;                                         // pages per vectored write of FlushAllPages
+static constexpr int DISK_SCHEDULER_WORKERS = 4;                                     // worker threads of disk scheduler
+static constexpr int DISK_IO_BATCH_SIZE = 32;                                        // requests per batch of a disk scheduler worker
 static constexpr int LOG_BUFFER_SIZE = ((BUFFER_POOL_SIZE + 1) * BUSTUB_PAGE_SIZE);  // size of a log buffer in byte
 static constexpr int BUCKET_SIZE = 50;                                               // size of extendible hash bucket
 static constexpr int LRUK_REPLACER_K = 10;  // lookback window for lru-k replacer
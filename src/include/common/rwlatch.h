@@ -21,18 +21,28 @@ namespace bustub {
 
 /**
  * Reader-Writer latch backed by std::mutex.
+ *
+ * Besides the read and the write mode the latch has an upgrade mode: an upgrade latch is shared with readers but
+ * excludes writers and other upgraders, so its holder can turn it into a write latch without letting another writer
+ * modify the protected data in between.
  */
 class ReaderWriterLatch {
  public:
   /**
    * Acquire a write latch.
    */
-  void WLock() { mutex_.lock(); }
+  void WLock() {
+    upgrade_mutex_.lock();
+    mutex_.lock();
+  }
 
   /**
    * Release a write latch.
    */
-  void WUnlock() { mutex_.unlock(); }
+  void WUnlock() {
+    mutex_.unlock();
+    upgrade_mutex_.unlock();
+  }
 
   /**
    * Acquire a read latch.
@@ -44,8 +54,41 @@ class ReaderWriterLatch {
    */
   void RUnlock() { mutex_.unlock_shared(); }
 
+  /**
+   * Try to acquire a read latch without blocking.
+   * @return true if the read latch is acquired
+   */
+  auto TryRLock() -> bool { return mutex_.try_lock_shared(); }
+
+  /**
+   * Acquire an upgrade latch.
+   */
+  void ULock() {
+    upgrade_mutex_.lock();
+    mutex_.lock_shared();
+  }
+
+  /**
+   * Release an upgrade latch.
+   */
+  void UUnlock() {
+    mutex_.unlock_shared();
+    upgrade_mutex_.unlock();
+  }
+
+  /**
+   * Turn the upgrade latch held by the caller into a write latch, waiting for the readers to leave. The latch is then
+   * released with WUnlock().
+   */
+  void Upgrade() {
+    mutex_.unlock_shared();
+    mutex_.lock();
+  }
+
  private:
   std::shared_mutex mutex_;
+  /** Held by the writer or the upgrader, if any. */
+  std::mutex upgrade_mutex_;
 };
 
 }  // namespace bustub
@@ -0,0 +1,46 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// lz_util.h
+//
+// Identification: src/include/common/util/lz_util.h
+//
+// Copyright (c) 2015-2023, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#pragma once
+
+#include <cstddef>
+
+namespace bustub {
+
+/**
+ * LzUtil is a small LZ77 codec in the style of LZ4, used to compress pages. The compressed data is a sequence of
+ * tokens; each token copies a run of literal bytes and then repeats a match of at least 4 bytes found at most 64 KiB
+ * back in the output:
+ *
+ *  ---------------------------------------------------------------------------------------------------------
+ *  | token (1) | extra literal length (0+) | literals | match offset (2) | extra match length (0+) | ... |
+ *  ---------------------------------------------------------------------------------------------------------
+ *
+ * The high nibble of the token is the literal length and the low nibble the match length minus 4, a nibble of 15 is
+ * followed by bytes that are added to it until one is below 255. The last token has literals only.
+ */
+class LzUtil {
+ public:
+  /**
+   * Compress size bytes of src into dst.
+   * @return the compressed size, 0 if it does not fit in capacity bytes
+   */
+  static auto Compress(const char *src, size_t size, char *dst, size_t capacity) -> size_t;
+
+  /**
+   * Decompress size bytes of src into dst.
+   * @return the decompressed size, 0 if src is corrupted or does not fit in capacity bytes
+   */
+  static auto Decompress(const char *src, size_t size, char *dst, size_t capacity) -> size_t;
+};
+
+}  // namespace bustub
@@ -16,6 +16,7 @@
 #include <condition_variable>  // NOLINT
 #include <future>              // NOLINT
 #include <mutex>               // NOLINT
+#include <thread>              // NOLINT
 
 #include "recovery/log_record.h"
 #include "storage/disk/disk_manager.h"
@@ -25,6 +26,11 @@ namespace bustub {
 /**
  * LogManager maintains a separate thread that is awakened whenever the log buffer is full or whenever a timeout
  * happens. When the thread is awakened, the log buffer's content is written into the disk log file.
+ *
+ * Commits are grouped: committing transactions append their records to the shared log buffer and wait in
+ * WaitForDurable(), while the flush thread alone writes the log. It swaps the log buffer with the flush buffer, writes
+ * the whole batch with one write + fdatasync and then wakes every waiter whose LSN became durable. Records appended
+ * during a flush go into the next batch, so the more transactions commit at once, the fewer syncs each one pays.
  */
 class LogManager {
  public:
@@ -35,6 +41,7 @@ class LogManager {
   }
 
   ~LogManager() {
+    StopFlushThread();
     delete[] log_buffer_;
     delete[] flush_buffer_;
     log_buffer_ = nullptr;
@@ -46,29 +53,53 @@ class LogManager {
 
   auto AppendLogRecord(LogRecord *log_record) -> lsn_t;
 
+  /**
+   * Block until the log records up to and including lsn are on disk, e.g. the commit record of a transaction. The
+   * flush thread writes them together with the records of the other waiters; without a flush thread the caller
+   * writes them.
+   * @param lsn the LSN that must become durable
+   */
+  void WaitForDurable(lsn_t lsn);
+
   inline auto GetNextLSN() -> lsn_t { return next_lsn_; }
   inline auto GetPersistentLSN() -> lsn_t { return persistent_lsn_; }
   inline void SetPersistentLSN(lsn_t lsn) { persistent_lsn_ = lsn; }
   inline auto GetLogBuffer() -> char * { return log_buffer_; }
 
  private:
-  // TODO(students): you may add your own member variables
+  /**
+   * Write the records of the log buffer to disk as one batch. The caller holds latch_ through lock, it is released
+   * during the write so that records keep being appended.
+   */
+  void FlushLogBuffer(std::unique_lock<std::mutex> *lock);
 
   /** The atomic counter which records the next log sequence number. */
   std::atomic<lsn_t> next_lsn_;
   /** The log records before and including the persistent lsn have been written to disk. */
   std::atomic<lsn_t> persistent_lsn_;
 
+  /** Records are appended to log_buffer_ while a flush writes flush_buffer_. */
   char *log_buffer_;
   char *flush_buffer_;
+  /** The number of bytes in log_buffer_ and the LSN of its last record. */
+  size_t log_buffer_size_{0};
+  lsn_t log_buffer_lsn_{INVALID_LSN};
 
+  /** Protects the buffers and the flags below. */
   std::mutex latch_;
 
-  std::thread *flush_thread_ __attribute__((__unused__));
+  std::thread *flush_thread_{nullptr};
 
+  /** Wakes the flush thread: a waiter needs its records on disk, the log buffer is full, or the thread stops. */
   std::condition_variable cv_;
-
-  DiskManager *disk_manager_ __attribute__((__unused__));
+  bool flush_requested_{false};
+  bool stop_flush_thread_{false};
+  /** A flush is writing flush_buffer_, the next one has to wait. */
+  bool flushing_{false};
+  /** Wakes the waiters for durability and the appenders waiting for room after every flush. */
+  std::condition_variable flushed_cv_;
+
+  DiskManager *disk_manager_;
 };
 
 }  // namespace bustub
@@ -12,11 +12,15 @@
 
 #pragma once
 
+#include <sys/types.h>
 #include <atomic>
+#include <cstdint>
 #include <fstream>
 #include <future>  // NOLINT
 #include <mutex>   // NOLINT
 #include <string>
+#include <unordered_map>
+#include <vector>
 
 #include "common/config.h"
 
@@ -25,19 +29,55 @@ namespace bustub {
 /**
  * DiskManager takes care of the allocation and deallocation of pages within a database. It performs the reading and
  * writing of pages to and from disk, providing a logical file layer within the context of a database management system.
+ *
+ * Page allocation is tracked by a bitmap with one bit per page id. Deallocated page ids are handed out again, the
+ * lowest one first, so the database file does not grow while it has holes; a new page is placed right after the
+ * previously allocated one whenever that page is free, so pages allocated together stay adjacent on disk. The
+ * file-backed disk manager keeps the bitmap in "<db>.fsm" next to the database file and writes every change through,
+ * a database file without a bitmap is assumed to have all of its pages allocated. The bitmap is not synced, so the
+ * allocation state is not crash-safe: after a crash the .fsm file may miss the latest allocations and deallocations.
+ *
+ * A table or an index allocates its pages from its own segment: extents of EXTENT_SIZE adjacent pages (one word of the
+ * bitmap) owned by the segment, so its pages are not interleaved with those of other objects and scanning it reads
+ * long runs of consecutive pages. A segment is identified by a page id of its object, e.g. its first page, which can
+ * be allocated with NEW_SEGMENT at the start of a fresh extent. A fully deallocated extent returns to the shared pool.
+ * The ownership of the extents is not persisted: after a restart a segment starts a new extent, and the free pages of
+ * the extents it owned before are used by allocations outside of segments.
+ *
+ * The page size is chosen when the database file is created and recorded in a header of DB_FILE_HEADER_SIZE bytes at
+ * the start of the file, the pages follow the header. Opening an existing database file uses the page size found in
+ * its header. A file written before the header was introduced has no magic at its start and a length that is a
+ * multiple of BUSTUB_PAGE_SIZE: it is opened as a legacy file, with pages of BUSTUB_PAGE_SIZE bytes starting at offset
+ * 0, and stays headerless.
+ *
+ * Pages are read and written with positional I/O (pread / pwritev) on one file descriptor and without any latch, so
+ * requests for different pages proceed in parallel; the length of the file is cached, so reads need no stat. With
+ * direct I/O the file is opened with O_DIRECT, bypassing the page cache. O_DIRECT requires buffers aligned to 4 KiB:
+ * the frames of the buffer pool are, other buffers are copied through an aligned one.
  */
 class DiskManager {
  public:
+  /** Alignment of the buffers, offsets and lengths of O_DIRECT I/O, the largest logical block size of common disks. */
+  static constexpr size_t DIRECT_IO_ALIGNMENT = 4096;
+
+  /** @return true if O_DIRECT can read into / write from the buffer */
+  static auto IsDirectIoAligned(const void *ptr) -> bool {
+    return reinterpret_cast<uintptr_t>(ptr) % DIRECT_IO_ALIGNMENT == 0;
+  }
+
   /**
    * Creates a new disk manager that writes to the specified database file.
    * @param db_file the file name of the database file to write to
+   * @param page_size the page size of the database if the file is created, a power of two between BUSTUB_PAGE_SIZE
+   * and BUSTUB_MAX_PAGE_SIZE
+   * @param direct_io whether to open the database file with O_DIRECT, ignored if the file system does not support it
    */
-  explicit DiskManager(const std::string &db_file);
+  explicit DiskManager(const std::string &db_file, size_t page_size = BUSTUB_PAGE_SIZE, bool direct_io = false);
 
   /** FOR TEST / LEADERBOARD ONLY, used by DiskManagerMemory */
   DiskManager() = default;
 
-  virtual ~DiskManager() = default;
+  virtual ~DiskManager();
 
   /**
    * Shut down the disk manager and close all the file resources.
@@ -51,6 +91,13 @@ class DiskManager {
    */
   virtual void WritePage(page_id_t page_id, const char *page_data);
 
+  /**
+   * Write consecutive pages to the database file with a single write.
+   * @param first_page_id id of the first page
+   * @param pages_data raw data of pages first_page_id, first_page_id + 1, ...
+   */
+  virtual void WritePages(page_id_t first_page_id, const std::vector<const char *> &pages_data);
+
   /**
    * Read a page from the database file.
    * @param page_id id of the page
@@ -58,6 +105,50 @@ class DiskManager {
    */
   virtual void ReadPage(page_id_t page_id, char *page_data);
 
+  /** A page read or write, part of a batch executed by ReadWritePages(). */
+  struct PageIo {
+    bool is_write_;
+    page_id_t page_id_;
+    char *data_;
+  };
+
+  /**
+   * Execute a batch of page reads and writes. Requests on the same page take effect in the order of the batch,
+   * requests on different pages may execute in any order. The default implementation executes them one by one.
+   * @param ios the requests
+   */
+  virtual void ReadWritePages(const std::vector<PageIo> &ios);
+
+  /**
+   * Allocate a page, reusing the lowest deallocated page id if there is one.
+   * @param segment INVALID_PAGE_ID to allocate outside of segments; the id of a segment to allocate from its extents,
+   * claiming a new extent when they are full; NEW_SEGMENT to allocate the first page of a new extent, its id
+   * identifies a new segment
+   * @return the id of the allocated page
+   */
+  auto AllocatePage(page_id_t segment = INVALID_PAGE_ID) -> page_id_t;
+
+  /**
+   * Deallocate a page so its id can be reused. Does nothing if the page is not allocated.
+   * @param page_id id of the page
+   */
+  virtual void DeallocatePage(page_id_t page_id);
+
+  /** @return true iff the page is allocated */
+  auto IsPageAllocated(page_id_t page_id) -> bool;
+
+  /** @return one past the highest allocated page id, every allocated page is below it */
+  auto GetNumPages() -> page_id_t;
+
+  /** @return true if the database file is accessed with O_DIRECT */
+  auto IsDirectIo() const -> bool { return direct_io_; }
+
+  /** @return the size of the pages of the database in bytes */
+  auto GetPageSize() const -> size_t { return page_size_; }
+
+  /** Size of the header at the start of the database file. */
+  static constexpr size_t DB_FILE_HEADER_SIZE = 4096;
+
   /**
    * Flush the entire log buffer into disk.
    * @param log_data raw log data
@@ -93,19 +184,90 @@ class DiskManager {
   inline auto HasFlushLogFuture() -> bool { return flush_log_f_ != nullptr; }
 
  protected:
+  /** Open or create a database file whose pages are compressed or not, see DiskManagerCompressed. */
+  DiskManager(const std::string &db_file, size_t page_size, bool direct_io, bool compressed);
+
   auto GetFileSize(const std::string &file_name) -> int;
-  // stream to write log file
-  std::fstream log_io_;
+
+  /** pwrite until everything is written. @return false on an I/O error */
+  static auto PwriteAll(int fd, const char *data, size_t size, size_t offset) -> bool;
+
+  /** pread until size bytes are read or the end of the file. @return the number of bytes read, -1 on an I/O error */
+  static auto PreadFull(int fd, char *data, size_t size, size_t offset) -> ssize_t;
+
+  /**
+   * Load the allocation bitmap from the .fsm file, or build it from the size of the database file.
+   * @param db_file_created true if the database file did not exist, a stale .fsm file is then discarded
+   */
+  void LoadAllocationBitmap(bool db_file_created);
+
+  /** Write the word of the bitmap holding the bit of page_id to the .fsm file, if there is one. */
+  void PersistAllocation(page_id_t page_id);
+
+  auto IsPageAllocatedLocked(page_id_t page_id) -> bool;
+
+  /** @return the segment owning the extent of the bitmap word, INVALID_PAGE_ID if it is shared */
+  auto ExtentOwnerLocked(size_t word) const -> page_id_t {
+    return word < extent_owners_.size() ? extent_owners_[word] : INVALID_PAGE_ID;
+  }
+
+  /** @return the lowest free page outside of the extents of segments, the page after the last allocation first */
+  auto FindSharedPageLocked() -> page_id_t;
+
+  /** @return a free page of the segment, claiming a new extent for it if its extents are full */
+  auto FindSegmentPageLocked(page_id_t segment) -> page_id_t;
+
+  /** Give the lowest extent without allocated pages and owner to the segment. @return its bitmap word */
+  auto ClaimExtentLocked(page_id_t segment) -> size_t;
+
+  /** Throw if page_size is not a power of two between BUSTUB_PAGE_SIZE and BUSTUB_MAX_PAGE_SIZE. */
+  static void CheckPageSize(size_t page_size);
+
+  /**
+   * Write the header of a new database file, or read the page size from the header of an existing one.
+   * @param compressed whether the pages of the file are compressed, an existing file must agree
+   */
+  void InitFileHeader(bool db_file_created, bool compressed);
+
+  /** @return the offset of the page in the database file */
+  auto PageOffset(page_id_t page_id) const -> size_t { return header_size_ + page_id * page_size_; }
+
+  /** Raise the cached length of the db file to end after a write, it never shrinks. */
+  void GrowFileSize(size_t end);
+
+  size_t page_size_{BUSTUB_PAGE_SIZE};
+  // offset of the first page, 0 for a legacy file without header
+  size_t header_size_{DB_FILE_HEADER_SIZE};
+
+  static constexpr int PAGES_PER_WORD = 64;
+  // one bit per page id, set if the page is allocated
+  std::vector<uint64_t> allocation_bitmap_;
+  // no free bit in the words below it
+  size_t first_free_word_{0};
+  page_id_t last_allocated_page_id_{INVALID_PAGE_ID};
+  page_id_t num_pages_{0};
+  static_assert(EXTENT_SIZE == PAGES_PER_WORD, "an extent is a word of the allocation bitmap");
+  // the segment owning each extent, INVALID_PAGE_ID for shared ones; not persisted
+  std::vector<page_id_t> extent_owners_;
+  // the extent a segment currently allocates from
+  std::unordered_map<page_id_t, size_t> segment_extents_;
+  // stream to write the allocation bitmap
+  std::fstream fsm_io_;
+  std::string fsm_name_;
+  std::mutex allocation_latch_;
+  // descriptor of the log file, opened for appending, -1 if it is not open
+  int log_fd_{-1};
   std::string log_name_;
-  // stream to write db file
-  std::fstream db_io_;
+  // descriptor of the db file, -1 if it is not open
+  int db_fd_{-1};
+  bool direct_io_{false};
+  // length of the db file, maintained by the writes
+  std::atomic<size_t> file_size_{0};
   std::string file_name_;
   int num_flushes_{0};
-  int num_writes_{0};
+  std::atomic<int> num_writes_{0};
   bool flush_log_{false};
   std::future<void> *flush_log_f_{nullptr};
-  // With multiple buffer pool instances, need to protect file access
-  std::mutex db_io_latch_;
 };
 
 }  // namespace bustub
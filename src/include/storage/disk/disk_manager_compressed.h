@@ -0,0 +1,110 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// disk_manager_compressed.h
+//
+// Identification: src/include/storage/disk/disk_manager_compressed.h
+//
+// Copyright (c) 2015-2023, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#pragma once
+
+#include <cstdint>
+#include <map>
+#include <mutex>  // NOLINT
+#include <string>
+#include <vector>
+
+#include "common/config.h"
+#include "storage/disk/disk_manager.h"
+
+namespace bustub {
+
+/**
+ * DiskManagerCompressed is a DiskManager which compresses the pages it writes, e.g. for cold data, and decompresses
+ * them when they are read, so the buffer pool still sees uncompressed pages. Pages are compressed with LzUtil; a page
+ * that does not compress below its size is stored as it is.
+ *
+ * After the header, the database file is divided into slots of SLOT_SIZE bytes. A page is stored in a run of
+ * consecutive slots anywhere in the file, found through an indirection map from the page id to its run and its stored
+ * length. Every write stores the page in a new run and only then points the map at it and frees the old run, so a
+ * crash of the process never tears a stored page. Free runs are reused first fit, the file grows only when none is
+ * large enough and shrinks when the last run is freed. The map is kept in "<db>.cmap" next to the database file and
+ * every change is written through; the free runs are rebuilt from it when the file is opened. Neither file is synced,
+ * like the .fsm file, so the format is not safe against a crash of the operating system. The header of a compressed
+ * database file is marked, it cannot be opened by a plain DiskManager and vice versa.
+ *
+ * The file is never opened with O_DIRECT: slots are not aligned to the logical blocks of the disk.
+ */
+class DiskManagerCompressed : public DiskManager {
+ public:
+  /** Size of the unit in which the database file is allocated to compressed pages. */
+  static constexpr size_t SLOT_SIZE = 256;
+
+  /**
+   * Creates a new compressing disk manager that writes to the specified database file.
+   * @param db_file the file name of the database file to write to
+   * @param page_size the page size of the database if the file is created
+   */
+  explicit DiskManagerCompressed(const std::string &db_file, size_t page_size = BUSTUB_PAGE_SIZE);
+
+  ~DiskManagerCompressed() override;
+
+  void WritePage(page_id_t page_id, const char *page_data) override;
+
+  /** Compressed pages are not adjacent in the file, they are written one by one. */
+  void WritePages(page_id_t first_page_id, const std::vector<const char *> &pages_data) override;
+
+  void ReadPage(page_id_t page_id, char *page_data) override;
+
+  /** Deallocate the page and free the slots storing it. */
+  void DeallocatePage(page_id_t page_id) override;
+
+  /** @return the number of bytes of the database file in the slots of pages, without the free runs and the header */
+  auto GetStoredSize() -> size_t;
+
+ private:
+  /** Entry of the indirection map, as stored in the .cmap file. */
+  struct SlotEntry {
+    uint32_t first_slot_;
+    uint32_t num_slots_;
+    // the stored length of the page, 0 if it was never written, the page size if it is not compressed
+    uint32_t length_;
+  };
+
+  /** Read the indirection map from the .cmap file and rebuild the free runs. */
+  void LoadSlotMap();
+
+  /** @return the first slot of a run of num_slots free slots, at the end of the file if no free run is large enough */
+  auto AllocateSlotsLocked(uint32_t num_slots) -> uint32_t;
+
+  /** Free a run of slots, merging it with its free neighbours, or trimming the file if it ends at end_slot_. */
+  void FreeSlotsLocked(uint32_t first_slot, uint32_t num_slots);
+
+  /** Cut the database file after end_slot_. */
+  void TruncateLocked();
+
+  /** Write the entry of the page to the .cmap file. */
+  void PersistEntryLocked(page_id_t page_id);
+
+  /** @return the offset of the slot in the database file */
+  static auto SlotOffset(uint32_t slot) -> size_t { return DB_FILE_HEADER_SIZE + static_cast<size_t>(slot) * SLOT_SIZE; }
+
+  std::mutex map_latch_;
+  // entry of each page id
+  std::vector<SlotEntry> slot_map_;
+  // free runs below end_slot_, from their first slot to their number of slots
+  std::map<uint32_t, uint32_t> free_runs_;
+  // one past the last slot of a run, no free run reaches it
+  uint32_t end_slot_{0};
+  // slots holding pages
+  size_t used_slots_{0};
+  // descriptor of the .cmap file, -1 if it is not open
+  int map_fd_{-1};
+  std::string map_name_;
+};
+
+}  // namespace bustub
@@ -9,13 +9,18 @@
 // Copyright (c) 2015-2020, Carnegie Mellon University Database Group
 //
 //===----------------------------------------------------------------------===//
+#include <algorithm>
 #include <array>
+#include <atomic>
+#include <chrono>  // NOLINT
 #include <cstring>
 #include <fstream>
+#include <functional>
 #include <future>  // NOLINT
 #include <memory>
 #include <mutex>  // NOLINT
 #include <optional>
+#include <queue>
 #include <shared_mutex>
 #include <string>
 #include <thread>  // NOLINT
@@ -35,7 +40,11 @@ namespace bustub {
  */
 class DiskManagerMemory : public DiskManager {
  public:
-  explicit DiskManagerMemory(size_t pages);
+  /**
+   * @param pages the number of pages the memory holds
+   * @param page_size the page size of the database
+   */
+  explicit DiskManagerMemory(size_t pages, size_t page_size = BUSTUB_PAGE_SIZE);
 
   ~DiskManagerMemory() override { delete[] memory_; }
 
@@ -46,6 +55,8 @@ class DiskManagerMemory : public DiskManager {
    */
   void WritePage(page_id_t page_id, const char *page_data) override;
 
+  void WritePages(page_id_t first_page_id, const std::vector<const char *> &pages_data) override;
+
   /**
    * Read a page from the database file.
    * @param page_id id of the page
@@ -57,13 +68,69 @@ class DiskManagerMemory : public DiskManager {
   char *memory_;
 };
 
+/**
+ * The performance of a simulated storage device. Every I/O waits for an access latency, which is lower when the I/O
+ * continues where the previous one ended, then for the transfer of its pages over the bandwidth of the device. The
+ * device serves at most queue_depth_ I/Os at once, a further I/O starts when the earliest of them completes; the
+ * transfers share the bandwidth, so they are serialized.
+ */
+struct DiskModel {
+  /** access latency of an I/O that does not continue the previous one (seek + rotation, flash read), microseconds */
+  uint64_t random_latency_us_{0};
+  /** access latency of an I/O starting at the page after the end of the previous I/O, microseconds */
+  uint64_t sequential_latency_us_{0};
+  /** transfer rate in MiB per second, 0 for unlimited */
+  uint64_t bandwidth_mib_per_s_{0};
+  /** the number of I/Os the device serves at once, 0 for unlimited */
+  size_t queue_depth_{0};
+
+  /** @return a device without any cost */
+  static auto None() -> DiskModel { return {}; }
+
+  /** @return an NVMe SSD: ~80us per I/O whatever the order, 2 GiB/s, deep queue */
+  static auto Nvme() -> DiskModel { return {80, 80, 2048, 64}; }
+
+  /** @return a SATA SSD: ~150us per I/O, 500 MiB/s, NCQ depth of 32 */
+  static auto Ssd() -> DiskModel { return {150, 150, 500, 32}; }
+
+  /** @return a spinning disk: ~8ms of seek and rotation for a random I/O, none for a sequential one, 150 MiB/s */
+  static auto Hdd() -> DiskModel { return {8000, 0, 150, 1}; }
+
+  /** @return the model named none, nvme, ssd or hdd; throws if the name is unknown */
+  static auto FromName(const std::string &name) -> DiskModel {
+    if (name == "none") {
+      return None();
+    }
+    if (name == "nvme") {
+      return Nvme();
+    }
+    if (name == "ssd") {
+      return Ssd();
+    }
+    if (name == "hdd") {
+      return Hdd();
+    }
+    throw Exception(ExceptionType::INVALID, "unknown disk model: " + name + ", expected none, nvme, ssd or hdd");
+  }
+};
+
 /**
  * DiskManagerMemory replicates the utility of DiskManager on memory. It is primarily used for
  * data structure performance testing.
+ *
+ * The cost of a real device can be simulated with a DiskModel: the I/Os of this disk manager then take the time the
+ * modelled device would take, with microsecond resolution. A batch (ReadWritePages) is in flight at once and
+ * completes when its last I/O does, consecutive pages written by WritePages are a single sequential I/O.
  */
 class DiskManagerUnlimitedMemory : public DiskManager {
  public:
-  DiskManagerUnlimitedMemory() = default;
+  using Clock = std::chrono::steady_clock;
+
+  /** @param page_size the page size of the database */
+  explicit DiskManagerUnlimitedMemory(size_t page_size = BUSTUB_PAGE_SIZE) {
+    CheckPageSize(page_size);
+    page_size_ = page_size;
+  }
 
   /**
    * Write a page to the database file.
@@ -71,34 +138,139 @@ class DiskManagerUnlimitedMemory : public DiskManager {
    * @param page_data raw page data
    */
   void WritePage(page_id_t page_id, const char *page_data) override {
-    if (latency_ > 0) {
-      std::this_thread::sleep_for(std::chrono::milliseconds(latency_));
+    auto done = ReserveIo(page_id, 1);
+    CopyIn(page_id, page_data);
+    Complete(done);
+  }
+
+  /**
+   * Write consecutive pages to the database file. The access latency is paid once for the whole batch.
+   * @param first_page_id id of the first page
+   * @param pages_data raw data of the pages
+   */
+  void WritePages(page_id_t first_page_id, const std::vector<const char *> &pages_data) override {
+    auto done = ReserveIo(first_page_id, pages_data.size());
+    for (size_t i = 0; i < pages_data.size(); i++) {
+      CopyIn(first_page_id + static_cast<page_id_t>(i), pages_data[i]);
+    }
+    Complete(done);
+  }
+
+  /**
+   * Read a page from the database file.
+   * @param page_id id of the page
+   * @param[out] page_data output buffer
+   */
+  void ReadPage(page_id_t page_id, char *page_data) override {
+    auto done = ReserveIo(page_id, 1);
+    CopyOut(page_id, page_data);
+    Complete(done);
+  }
+
+  /** The I/Os of the batch are queued on the simulated device together, so they overlap up to its queue depth. */
+  void ReadWritePages(const std::vector<PageIo> &ios) override {
+    Clock::time_point done{};
+    batch_done_ = &done;
+    DiskManager::ReadWritePages(ios);
+    batch_done_ = nullptr;
+    WaitUntil(done);
+  }
+
+  /** Simulate a device taking latency_ms milliseconds for every I/O. */
+  void SetLatency(size_t latency_ms) {
+    DiskModel model;
+    model.random_latency_us_ = model.sequential_latency_us_ = latency_ms * 1000;
+    SetDiskModel(model);
+  }
+
+  /** Simulate the device described by model, DiskModel::None() turns the simulation off. */
+  void SetDiskModel(const DiskModel &model) {
+    std::scoped_lock lock(device_latch_);
+    model_ = model;
+    in_service_ = {};
+    transfer_end_ = {};
+    simulated_ = model.random_latency_us_ > 0 || model.sequential_latency_us_ > 0 || model.bandwidth_mib_per_s_ > 0;
+  }
+
+  auto GetDiskModel() -> DiskModel {
+    std::scoped_lock lock(device_latch_);
+    return model_;
+  }
+
+ private:
+  /**
+   * Queue an I/O of num_pages pages starting at page_id on the simulated device.
+   * @return the time the device completes it
+   */
+  auto ReserveIo(page_id_t page_id, size_t num_pages) -> Clock::time_point {
+    if (!simulated_) {
+      return {};
+    }
+    std::scoped_lock lock(device_latch_);
+    auto now = Clock::now();
+    bool sequential = page_id == next_page_id_;
+    next_page_id_ = page_id + static_cast<page_id_t>(num_pages);
+    while (!in_service_.empty() && in_service_.top() <= now) {
+      in_service_.pop();
+    }
+    auto start = now;
+    if (model_.queue_depth_ > 0 && in_service_.size() >= model_.queue_depth_) {
+      // wait for a slot of the queue
+      start = in_service_.top();
+      in_service_.pop();
     }
+    auto done = start + std::chrono::microseconds(sequential ? model_.sequential_latency_us_ : model_.random_latency_us_);
+    if (model_.bandwidth_mib_per_s_ > 0) {
+      auto transfer = std::chrono::nanoseconds(num_pages * page_size_ * 1000000000 /
+                                               (model_.bandwidth_mib_per_s_ * 1024 * 1024));
+      transfer_end_ = std::max(transfer_end_, done) + transfer;
+      done = transfer_end_;
+    }
+    in_service_.push(done);
+    return done;
+  }
+
+  /** Wait for an I/O to complete, or add it to the batch the calling thread executes. */
+  static void Complete(Clock::time_point done) {
+    if (batch_done_ != nullptr) {
+      *batch_done_ = std::max(*batch_done_, done);
+      return;
+    }
+    WaitUntil(done);
+  }
 
+  /** Block until the time point, sleeping while it is far and spinning for the last microseconds. */
+  static void WaitUntil(Clock::time_point done) {
+    static constexpr auto SPIN = std::chrono::microseconds(100);
+    if (done == Clock::time_point{}) {
+      return;
+    }
+    auto now = Clock::now();
+    if (done - now > SPIN) {
+      std::this_thread::sleep_until(done - SPIN);
+    }
+    while (Clock::now() < done) {
+      std::this_thread::yield();
+    }
+  }
+
+  void CopyIn(page_id_t page_id, const char *page_data) {
     std::unique_lock<std::mutex> l(mutex_);
     if (page_id >= static_cast<int>(data_.size())) {
       data_.resize(page_id + 1);
     }
     if (data_[page_id] == nullptr) {
       data_[page_id] = std::make_shared<ProtectedPage>();
+      data_[page_id]->first.resize(page_size_);
     }
     std::shared_ptr<ProtectedPage> ptr = data_[page_id];
     std::unique_lock<std::shared_mutex> l_page(ptr->second);
     l.unlock();
 
-    memcpy(ptr->first.data(), page_data, BUSTUB_PAGE_SIZE);
+    memcpy(ptr->first.data(), page_data, page_size_);
   }
 
-  /**
-   * Read a page from the database file.
-   * @param page_id id of the page
-   * @param[out] page_data output buffer
-   */
-  void ReadPage(page_id_t page_id, char *page_data) override {
-    if (latency_ > 0) {
-      std::this_thread::sleep_for(std::chrono::milliseconds(latency_));
-    }
-
+  void CopyOut(page_id_t page_id, char *page_data) {
     std::unique_lock<std::mutex> l(mutex_);
     if (page_id >= static_cast<int>(data_.size()) || page_id < 0) {
       LOG_WARN("page not exist");
@@ -112,17 +284,27 @@ class DiskManagerUnlimitedMemory : public DiskManager {
     std::shared_lock<std::shared_mutex> l_page(ptr->second);
     l.unlock();
 
-    memcpy(page_data, ptr->first.data(), BUSTUB_PAGE_SIZE);
+    memcpy(page_data, ptr->first.data(), page_size_);
   }
 
-  void SetLatency(size_t latency_ms) { latency_ = latency_ms; }
-
- private:
   std::mutex mutex_;
-  using Page = std::array<char, BUSTUB_PAGE_SIZE>;
+  using Page = std::vector<char>;
   using ProtectedPage = std::pair<Page, std::shared_mutex>;
   std::vector<std::shared_ptr<ProtectedPage>> data_;
-  size_t latency_{0};
+
+  // state of the simulated device
+  std::mutex device_latch_;
+  // false while the model has no cost, the I/Os then skip the device
+  std::atomic<bool> simulated_{false};
+  DiskModel model_;
+  // completion times of the I/Os the device is serving
+  std::priority_queue<Clock::time_point, std::vector<Clock::time_point>, std::greater<>> in_service_;
+  // the end of the last transfer, transfers share the bandwidth
+  Clock::time_point transfer_end_{};
+  // the page after the previous I/O, an I/O starting there is sequential
+  page_id_t next_page_id_{INVALID_PAGE_ID};
+  // completion of the batch the thread executes in ReadWritePages, its I/Os do not wait one by one
+  inline static thread_local Clock::time_point *batch_done_ = nullptr;
 };
 
 }  // namespace bustub
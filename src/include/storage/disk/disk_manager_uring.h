@@ -0,0 +1,81 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// disk_manager_uring.h
+//
+// Identification: src/include/storage/disk/disk_manager_uring.h
+//
+// Copyright (c) 2015-2023, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#pragma once
+
+#include <memory>
+#include <mutex>  // NOLINT
+#include <string>
+#include <vector>
+
+#include "common/config.h"
+#include "storage/disk/disk_manager.h"
+
+namespace bustub {
+
+/**
+ * DiskManagerUring is a DiskManager which executes the batches of the disk scheduler through Linux io_uring: the
+ * reads and writes of a batch are put into the submission queue together and submitted and waited for with a single
+ * io_uring_enter system call, instead of one pread / pwrite per page.
+ *
+ * Every worker of the disk scheduler takes a ring from a pool, so the workers never share a ring. The requests of a
+ * batch on the same page are submitted one after the other to keep their order. Requests io_uring cannot serve
+ * (unaligned buffers with O_DIRECT, reads past the end of the file, failed or short transfers) and single requests go
+ * through pread / pwrite. When the kernel does not provide io_uring, or it is forbidden (e.g. by seccomp), the disk
+ * manager falls back to pread / pwrite for everything.
+ */
+class DiskManagerUring : public DiskManager {
+ public:
+  /**
+   * Creates a new io_uring disk manager that writes to the specified database file.
+   * @param db_file the file name of the database file to write to
+   * @param page_size the page size of the database if the file is created
+   * @param direct_io whether to open the database file with O_DIRECT, ignored if the file system does not support it
+   * @param queue_depth the number of requests submitted at once by one ring
+   */
+  explicit DiskManagerUring(const std::string &db_file, size_t page_size = BUSTUB_PAGE_SIZE, bool direct_io = true,
+                            unsigned queue_depth = DISK_IO_BATCH_SIZE);
+
+  ~DiskManagerUring() override;
+
+  void ReadWritePages(const std::vector<PageIo> &ios) override;
+
+  /** @return true if the batches go through io_uring, false if the disk manager fell back to pread / pwrite */
+  auto UsesIoUring() const -> bool { return uses_io_uring_; }
+
+ private:
+  /** An io_uring instance with its mapped submission and completion queues, defined in disk_manager_uring.cpp. */
+  class Ring;
+
+  /** @return a ring of the pool, or a new one; nullptr if no ring can be set up */
+  auto AcquireRing() -> std::unique_ptr<Ring>;
+
+  /** Return a ring to the pool. */
+  void ReleaseRing(std::unique_ptr<Ring> ring);
+
+  /**
+   * Submit the requests ios[i] for i in segment, wait for them and clear segment. Requests the ring failed to serve
+   * are executed with pread / pwrite.
+   * @return false if the ring is unusable afterwards
+   */
+  auto RunSegment(Ring *ring, const std::vector<PageIo> &ios, std::vector<size_t> *segment) -> bool;
+
+  /** @return true if the request can be submitted to io_uring */
+  auto CanSubmit(const PageIo &io) const -> bool;
+
+  unsigned queue_depth_;
+  bool uses_io_uring_{false};
+  std::mutex rings_latch_;
+  std::vector<std::unique_ptr<Ring>> rings_;
+};
+
+}  // namespace bustub
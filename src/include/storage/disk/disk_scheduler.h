@@ -0,0 +1,105 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// disk_scheduler.h
+//
+// Identification: src/include/storage/disk/disk_scheduler.h
+//
+// Copyright (c) 2015-2023, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#pragma once
+
+#include <future>  // NOLINT
+#include <optional>
+#include <thread>  // NOLINT
+#include <vector>
+
+#include "common/channel.h"
+#include "common/config.h"
+#include "storage/disk/disk_manager.h"
+
+namespace bustub {
+
+/**
+ * @brief Represents a Write or Read request for the DiskManager to execute.
+ */
+struct DiskRequest {
+  /** Flag indicating whether the request is a write or a read. */
+  bool is_write_;
+
+  /**
+   *  Pointer to the start of the memory location where a page is either:
+   *   1. being read into from disk (on a read).
+   *   2. being written out to disk (on a write).
+   */
+  char *data_;
+
+  /** ID of the page being read from / written to disk. */
+  page_id_t page_id_;
+
+  /** Callback used to signal to the request issuer when the request has been completed. */
+  std::promise<bool> callback_;
+};
+
+/**
+ * @brief The DiskScheduler schedules disk read and write operations.
+ *
+ * A request is scheduled by calling DiskScheduler::Schedule() with an appropriate DiskRequest object. The scheduler
+ * maintains a pool of background worker threads that process the scheduled requests using the disk manager, so the
+ * callers can keep many requests in flight and wait on their futures only when they need the result.
+ *
+ * Every worker owns its own request queue and a page is always served by the same worker, so requests on the same
+ * page complete in the order they were scheduled, while requests on different pages proceed in parallel.
+ * A worker takes up to DISK_IO_BATCH_SIZE queued requests at a time and hands them to the disk manager as one batch
+ * (DiskManager::ReadWritePages), which lets an asynchronous disk manager keep them all in flight together.
+ */
+class DiskScheduler {
+ public:
+  /**
+   * @brief Creates a new DiskScheduler.
+   * @param disk_manager the disk manager which executes the requests
+   * @param num_workers the number of background worker threads
+   */
+  explicit DiskScheduler(DiskManager *disk_manager, size_t num_workers = DISK_SCHEDULER_WORKERS);
+  ~DiskScheduler();
+
+  /**
+   * @brief Schedules a request for the DiskManager to execute.
+   *
+   * @param r The request to be scheduled.
+   */
+  void Schedule(DiskRequest r);
+
+  /**
+   * @brief Background worker thread function that processes the requests of the idx-th queue.
+   *
+   * The worker runs until the destructor puts a `std::nullopt` into its queue.
+   */
+  void StartWorkerThread(size_t idx);
+
+  using DiskSchedulerPromise = std::promise<bool>;
+
+  /**
+   * @brief Create a Promise object. If you want to implement your own version of promise, you can change this function
+   * so that our test cases can use your promise implementation.
+   *
+   * @return std::promise<bool>
+   */
+  auto CreatePromise() -> DiskSchedulerPromise { return {}; };
+
+  /** @brief Return the disk manager which executes the requests. */
+  auto GetDiskManager() -> DiskManager * { return disk_manager_; }
+
+ private:
+  /** Pointer to the disk manager. */
+  DiskManager *disk_manager_;
+  /** One queue per worker. A `std::nullopt` in a queue signals its worker to stop. */
+  std::vector<Channel<std::optional<DiskRequest>>> request_queues_;
+  /** The background worker threads. */
+  std::vector<std::thread> workers_;
+};
+
+}  // namespace bustub
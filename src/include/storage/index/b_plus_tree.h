@@ -65,9 +65,12 @@ class BPlusTree {
   using LeafPage = BPlusTreeLeafPage<KeyType, ValueType, KeyComparator>;
 
  public:
+  /**
+   * @param leaf_max_size max size of the leaf pages, 0 to fill the pages of the buffer pool
+   * @param internal_max_size max size of the internal pages, 0 to fill the pages of the buffer pool
+   */
   explicit BPlusTree(std::string name, page_id_t header_page_id, BufferPoolManager *buffer_pool_manager,
-                     const KeyComparator &comparator, int leaf_max_size = LEAF_PAGE_SIZE,
-                     int internal_max_size = INTERNAL_PAGE_SIZE);
+                     const KeyComparator &comparator, int leaf_max_size = 0, int internal_max_size = 0);
 
   // Returns true if this B+ tree has no keys and values.
   auto IsEmpty() const -> bool;
@@ -134,6 +137,31 @@ class BPlusTree {
 
   void FindPath(const KeyType &key, Context& ctx, bool write, Transaction *txn = nullptr);
 
+  /**
+   * @brief Read descent with optimistic latch coupling: the header and inner pages are read through
+   * OptimisticPageGuard and validated after their child pointer was taken, only the leaf is read latched.
+   * @return false if a page was not resident or changed during the descent, ctx is left empty then
+   */
+  auto FindLeafOptimistic(const KeyType &key, Context &ctx) -> bool;
+
+  /**
+   * @brief Write descent of an insert or a remove that only modifies its leaf: the inner pages are read like in
+   * FindLeafOptimistic and only the leaf is write latched, so writers to different leaves do not serialize on the
+   * latches of the header and the root. The leaf is first taken with its upgrade latch and upgraded only if the
+   * operation cannot split it, make it underflow or empty the tree; otherwise the caller restarts with FindPath.
+   * @param insert true for an insert, false for a remove
+   * @return true if the write guard of the leaf is the only guard in ctx, false if ctx is left empty
+   */
+  auto FindLeafOptimisticWrite(const KeyType &key, Context &ctx, bool insert) -> bool;
+
+  /**
+   * @brief Descend from the header to the leaf of the key through OptimisticPageGuard, validating every page after
+   * its child pointer was taken.
+   * @param[out] leaf the guard of the leaf, not validated yet; empty if the tree is empty
+   * @return false if a page was not resident or changed during the descent
+   */
+  auto DescendOptimistic(const KeyType &key, Context &ctx, OptimisticPageGuard *leaf) -> bool;
+
   void InsertInParent(page_id_t left_child, KeyType key, page_id_t right_child, Context& ctx);
 
   void ChangeRoot(page_id_t left_child, KeyType key, page_id_t right_child, Context &ctx);
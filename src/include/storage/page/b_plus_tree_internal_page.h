@@ -47,6 +47,14 @@ class BPlusTreeInternalPage : public BPlusTreePage {
    */
   void Init(int max_size = INTERNAL_PAGE_SIZE);
 
+  /**
+   * @return the number of key & page id pairs an internal page of the given page size has room for. A page holds one
+   * pair more than its max size before it is split.
+   */
+  static constexpr auto Capacity(size_t page_size) -> int {
+    return static_cast<int>((page_size - INTERNAL_PAGE_HEADER_SIZE) / sizeof(MappingType));
+  }
+
   /**
    * @param index The index of the key to get. Index must be non-zero.
    * @return Key at index
@@ -76,6 +84,9 @@ class BPlusTreeInternalPage : public BPlusTreePage {
   // 二分查找第一个大于等于key的位置
   auto KeyIndex(const KeyType &key, const KeyComparator &comparator) const -> int;
 
+  // 乐观读时查找key所在的孩子：只使用调用者读到并检查过的size，也不做断言，页可能正在被修改
+  auto LookupChild(const KeyType &key, const KeyComparator &comparator, int size) const -> ValueType;
+
   auto Insert(const ValueType& left_child , const KeyType &key, const ValueType &right_child, const KeyComparator &comparator) -> int;
 
   // 将this的[begin, end)的数据移动追加到dest
@@ -12,6 +12,8 @@
 
 #pragma once
 
+#include <atomic>
+#include <condition_variable>  // NOLINT
 #include <cstring>
 #include <iostream>
 
@@ -24,20 +26,28 @@ namespace bustub {
  * Page is the basic unit of storage within the database system. Page provides a wrapper for actual data pages being
  * held in main memory. Page also contains book-keeping information that is used by the buffer pool manager, e.g.
  * pin count, dirty flag, page id, etc.
+ *
+ * The data of a page lives in the frame arena of the buffer pool manager, apart from the book-keeping information.
+ * Every Page object starts on its own cache line, so the metadata of neighbouring frames is never falsely shared.
+ *
+ * The book-keeping fields are atomic because the buffer pool manager pins and unpins resident pages without taking the
+ * latch of their partition. A pin count of -1 means the frame is being evicted and cannot be pinned.
+ *
+ * Every frame also carries a version counter, which is odd while a writer holds the page latch or while the buffer
+ * pool replaces the content of the frame, and is bumped again when that ends. An optimistic reader remembers an even
+ * version, reads the page without latching or pinning it, and trusts what it read only if the version is unchanged
+ * afterwards.
  */
-class Page {
+class alignas(CACHE_LINE_SIZE) Page {
   // There is book-keeping information inside the page that should only be relevant to the buffer pool manager.
   friend class BufferPoolManager;
 
  public:
-  /** Constructor. Zeros out the page data. */
-  Page() {
-    data_ = new char[BUSTUB_PAGE_SIZE];
-    ResetMemory();
-  }
+  /** Constructor. The buffer pool manager attaches the page to a zeroed frame of its arena. */
+  Page() = default;
 
   /** Default destructor. */
-  ~Page() { delete[] data_; }
+  ~Page() = default;
 
   /** @return the actual data contained within this page */
   inline auto GetData() -> char * { return data_; }
@@ -52,10 +62,16 @@ class Page {
   inline auto IsDirty() -> bool { return is_dirty_; }
 
   /** Acquire the page write latch. */
-  inline void WLatch() { rwlatch_.WLock(); }
+  inline void WLatch() {
+    rwlatch_.WLock();
+    version_.fetch_add(1, std::memory_order_acq_rel);
+  }
 
   /** Release the page write latch. */
-  inline void WUnlatch() { rwlatch_.WUnlock(); }
+  inline void WUnlatch() {
+    version_.fetch_add(1, std::memory_order_release);
+    rwlatch_.WUnlock();
+  }
 
   /** Acquire the page read latch. */
   inline void RLatch() { rwlatch_.RLock(); }
@@ -63,6 +79,30 @@ class Page {
   /** Release the page read latch. */
   inline void RUnlatch() { rwlatch_.RUnlock(); }
 
+  /** Try to acquire the page read latch without blocking. @return true if the latch is acquired */
+  inline auto TryRLatch() -> bool { return rwlatch_.TryRLock(); }
+
+  /** Acquire the page upgrade latch, it is shared with readers but excludes writers and other upgraders. */
+  inline void ULatch() { rwlatch_.ULock(); }
+
+  /** Release the page upgrade latch. */
+  inline void UUnlatch() { rwlatch_.UUnlock(); }
+
+  /** Turn the page upgrade latch into the write latch, which is then released with WUnlatch(). */
+  inline void UpgradeLatch() {
+    rwlatch_.Upgrade();
+    version_.fetch_add(1, std::memory_order_acq_rel);
+  }
+
+  /** @return the version of the page, odd while the page is being modified */
+  inline auto ReadVersion() -> uint64_t { return version_.load(std::memory_order_acquire); }
+
+  /** @return true if the page has not been modified since ReadVersion() returned version */
+  inline auto ValidateVersion(uint64_t version) -> bool {
+    std::atomic_thread_fence(std::memory_order_acquire);
+    return version_.load(std::memory_order_relaxed) == version;
+  }
+
   /** @return the page LSN. */
   inline auto GetLSN() -> lsn_t { return *reinterpret_cast<lsn_t *>(GetData() + OFFSET_LSN); }
 
@@ -79,18 +119,29 @@ class Page {
 
  private:
   /** Zeroes out the data that is held within the page. */
-  inline void ResetMemory() { memset(data_, OFFSET_PAGE_START, BUSTUB_PAGE_SIZE); }
+  inline void ResetMemory() { memset(data_, OFFSET_PAGE_START, size_); }
 
-  /** The actual data that is stored within a page. */
-  // Usually this should be stored as `char data_[BUSTUB_PAGE_SIZE]{};`. But to enable ASAN to detect page overflow,
-  // we store it as a ptr.
-  char *data_;
+  /** The actual data that is stored within a page, points into the frame arena of the buffer pool manager. */
+  // With ASAN, every frame in the arena is followed by a poisoned guard page, so page overflow is still detected.
+  char *data_{nullptr};
+  /** The size of the page data, the page size of the database. */
+  size_t size_{BUSTUB_PAGE_SIZE};
   /** The ID of this page. */
-  page_id_t page_id_ = INVALID_PAGE_ID;
-  /** The pin count of this page. */
-  int pin_count_ = 0;
+  std::atomic<page_id_t> page_id_ = INVALID_PAGE_ID;
+  /** The pin count of this page, -1 while the frame is claimed for eviction. */
+  std::atomic<int> pin_count_ = 0;
   /** True if the page is dirty, i.e. it is different from its corresponding page on disk. */
-  bool is_dirty_ = false;
+  std::atomic<bool> is_dirty_ = false;
+  /** True while the buffer pool manager is reading the page into this frame or writing back its previous page. */
+  std::atomic<bool> io_in_progress_ = false;
+  /** True if the page was loaded by read-ahead and has not been accessed by a scan since. */
+  std::atomic<bool> read_ahead_ = false;
+  /** True if the frame belongs to the scan ring of its buffer pool partition. */
+  std::atomic<bool> in_scan_ring_ = false;
+  /** Version counter for optimistic readers, see the class comment. */
+  std::atomic<uint64_t> version_ = 0;
+  /** Signalled when the I/O on this frame completes. */
+  std::condition_variable io_cv_;
   /** Page latch. */
   ReaderWriterLatch rwlatch_;
 };
@@ -81,6 +81,7 @@ class BasicPageGuard {
  private:
   friend class ReadPageGuard;
   friend class WritePageGuard;
+  friend class UpgradablePageGuard;
 
   [[maybe_unused]] BufferPoolManager *bpm_{nullptr};
   Page *page_{nullptr};
@@ -217,9 +218,92 @@ class WritePageGuard {
   }
 
  private:
+  friend class UpgradablePageGuard;
+
+  /** Take over a pinned page whose write latch is already held. */
+  explicit WritePageGuard(BasicPageGuard &&guard) : guard_(std::move(guard)), locked_(true) {}
+
   // You may choose to get rid of this and add your own private variables.
   BasicPageGuard guard_;
   bool locked_ = false;
 };
 
+/**
+ * UpgradablePageGuard holds the upgrade latch of a page: readers can still read the page, but no writer can modify
+ * it, so code that usually only reads (e.g. a B+ tree leaf insert without a split) can look at the page first and
+ * call Upgrade() only when it has to write, instead of taking the write latch pessimistically or fetching the page
+ * again. Only one thread can hold the upgrade or the write latch of a page at a time.
+ */
+class UpgradablePageGuard {
+ public:
+  UpgradablePageGuard() = default;
+  UpgradablePageGuard(BufferPoolManager *bpm, Page *page) : guard_(bpm, page) {
+    guard_.page_->ULatch();
+    locked_ = true;
+  }
+  UpgradablePageGuard(const UpgradablePageGuard &) = delete;
+  auto operator=(const UpgradablePageGuard &) -> UpgradablePageGuard & = delete;
+  UpgradablePageGuard(UpgradablePageGuard &&that) noexcept;
+  auto operator=(UpgradablePageGuard &&that) noexcept -> UpgradablePageGuard &;
+
+  /** @brief Release the upgrade latch, then unpin the page. */
+  void Drop();
+
+  ~UpgradablePageGuard();
+
+  /**
+   * @brief Turn the upgrade latch into the write latch, waiting for the readers of the page to leave. The page cannot
+   * have been modified since this guard was created. This guard is empty afterwards.
+   * @return a write guard on the same page
+   */
+  auto Upgrade() -> WritePageGuard;
+
+  auto PageId() -> page_id_t { return guard_.PageId(); }
+
+  auto GetData() -> const char * { return guard_.GetData(); }
+
+  template <class T>
+  auto As() -> const T * {
+    return guard_.As<T>();
+  }
+
+ private:
+  BasicPageGuard guard_;
+  bool locked_ = false;
+};
+
+/**
+ * OptimisticPageGuard reads a resident page without pinning or latching it, so readers never write to the cache lines
+ * of the frame. The guard remembers the version of the page when it was created; whatever is read through it may be
+ * inconsistent, and must only be trusted once Validate() returned true after the read. The frame may be modified or
+ * even given to another page meanwhile, so a reader must not follow pointers or loop on sizes it read without checking
+ * their bounds first.
+ */
+class OptimisticPageGuard {
+ public:
+  OptimisticPageGuard() = default;
+  OptimisticPageGuard(Page *page, page_id_t page_id, uint64_t version)
+      : page_(page), page_id_(page_id), version_(version) {}
+
+  /** @return false if the page could not be read optimistically, because it is not resident or being modified */
+  auto IsValid() -> bool { return page_ != nullptr; }
+
+  /** @return true if the page has not been modified or replaced since the guard was created */
+  auto Validate() -> bool { return page_ != nullptr && page_->ValidateVersion(version_); }
+
+  auto PageId() -> page_id_t { return page_id_; }
+
+  auto GetData() -> const char * { return page_->GetData(); }
+
+  template <class T>
+  auto As() -> const T * {
+    return reinterpret_cast<const T *>(GetData());
+  }
+
+ private:
+  Page *page_{nullptr};
+  page_id_t page_id_{INVALID_PAGE_ID};
+  uint64_t version_{0};
+};
+
 }  // namespace bustub
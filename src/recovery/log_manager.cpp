@@ -12,6 +12,10 @@
 
 #include "recovery/log_manager.h"
 
+#include <cstring>
+
+#include "common/macros.h"
+
 namespace bustub {
 /*
  * set enable_logging = true
@@ -22,12 +26,51 @@ namespace bustub {
  *
  * This thread runs forever until system shutdown/StopFlushThread
  */
-void LogManager::RunFlushThread() {}
+void LogManager::RunFlushThread() {
+  std::unique_lock<std::mutex> lock(latch_);
+  if (flush_thread_ != nullptr) {
+    return;
+  }
+  enable_logging = true;
+  stop_flush_thread_ = false;
+  flush_thread_ = new std::thread([this] {
+    std::unique_lock<std::mutex> flush_lock(latch_);
+    while (true) {
+      cv_.wait_for(flush_lock, log_timeout, [this] { return flush_requested_ || stop_flush_thread_; });
+      // requests made during the flush are for the next batch
+      flush_requested_ = false;
+      if (log_buffer_size_ > 0) {
+        // everything appended until now goes into this batch
+        FlushLogBuffer(&flush_lock);
+      }
+      if (stop_flush_thread_ && log_buffer_size_ == 0) {
+        break;
+      }
+    }
+  });
+}
 
 /*
  * Stop and join the flush thread, set enable_logging = false
  */
-void LogManager::StopFlushThread() {}
+void LogManager::StopFlushThread() {
+  std::thread *flush_thread;
+  {
+    std::scoped_lock lock(latch_);
+    if (flush_thread_ == nullptr) {
+      return;
+    }
+    stop_flush_thread_ = true;
+    flush_thread = flush_thread_;
+  }
+  cv_.notify_one();
+  // the thread writes the records left in the log buffer before it exits
+  flush_thread->join();
+  delete flush_thread;
+  std::scoped_lock lock(latch_);
+  flush_thread_ = nullptr;
+  enable_logging = false;
+}
 
 /*
  * append a log record into log buffer
@@ -49,6 +92,89 @@ void LogManager::StopFlushThread() {}
  *  }
  *
  */
-auto LogManager::AppendLogRecord(LogRecord *log_record) -> lsn_t { return INVALID_LSN; }
+auto LogManager::AppendLogRecord(LogRecord *log_record) -> lsn_t {
+  auto size = static_cast<size_t>(log_record->size_);
+  BUSTUB_ASSERT(size <= static_cast<size_t>(LOG_BUFFER_SIZE), "log record larger than the log buffer");
+  std::unique_lock<std::mutex> lock(latch_);
+  while (log_buffer_size_ + size > static_cast<size_t>(LOG_BUFFER_SIZE)) {
+    // the log buffer is full, it has to be flushed first
+    if (flush_thread_ == nullptr) {
+      FlushLogBuffer(&lock);
+      continue;
+    }
+    flush_requested_ = true;
+    cv_.notify_one();
+    flushed_cv_.wait(lock);
+  }
+
+  log_record->lsn_ = next_lsn_++;
+  char *pos = log_buffer_ + log_buffer_size_;
+  // the header: size, lsn, txn id, prev lsn, type
+  memcpy(pos, log_record, LogRecord::HEADER_SIZE);
+  pos += LogRecord::HEADER_SIZE;
+  switch (log_record->log_record_type_) {
+    case LogRecordType::INSERT:
+      memcpy(pos, &log_record->insert_rid_, sizeof(RID));
+      log_record->insert_tuple_.SerializeTo(pos + sizeof(RID));
+      break;
+    case LogRecordType::MARKDELETE:
+    case LogRecordType::APPLYDELETE:
+    case LogRecordType::ROLLBACKDELETE:
+      memcpy(pos, &log_record->delete_rid_, sizeof(RID));
+      log_record->delete_tuple_.SerializeTo(pos + sizeof(RID));
+      break;
+    case LogRecordType::UPDATE:
+      memcpy(pos, &log_record->update_rid_, sizeof(RID));
+      pos += sizeof(RID);
+      log_record->old_tuple_.SerializeTo(pos);
+      pos += sizeof(int32_t) + log_record->old_tuple_.GetLength();
+      log_record->new_tuple_.SerializeTo(pos);
+      break;
+    case LogRecordType::NEWPAGE:
+      memcpy(pos, &log_record->prev_page_id_, sizeof(page_id_t));
+      memcpy(pos + sizeof(page_id_t), &log_record->page_id_, sizeof(page_id_t));
+      break;
+    default:
+      break;
+  }
+  log_buffer_size_ += size;
+  log_buffer_lsn_ = log_record->lsn_;
+  return log_record->lsn_;
+}
+
+void LogManager::WaitForDurable(lsn_t lsn) {
+  BUSTUB_ASSERT(lsn < next_lsn_, "waiting for a log record that was not appended");
+  std::unique_lock<std::mutex> lock(latch_);
+  while (persistent_lsn_ < lsn) {
+    if (flush_thread_ == nullptr) {
+      // no flush thread, the caller writes the batch itself
+      FlushLogBuffer(&lock);
+      continue;
+    }
+    flush_requested_ = true;
+    cv_.notify_one();
+    flushed_cv_.wait(lock);
+  }
+}
+
+void LogManager::FlushLogBuffer(std::unique_lock<std::mutex> *lock) {
+  // flush_buffer_ is free once the previous flush completed
+  flushed_cv_.wait(*lock, [this] { return !flushing_; });
+  if (log_buffer_size_ == 0) {
+    return;
+  }
+  std::swap(log_buffer_, flush_buffer_);
+  size_t size = log_buffer_size_;
+  lsn_t lsn = log_buffer_lsn_;
+  log_buffer_size_ = 0;
+  flushing_ = true;
+  lock->unlock();
+  // one write + fdatasync for all the records of the batch
+  disk_manager_->WriteLog(flush_buffer_, static_cast<int>(size));
+  lock->lock();
+  flushing_ = false;
+  persistent_lsn_ = lsn;
+  flushed_cv_.notify_all();
+}
 
 }  // namespace bustub
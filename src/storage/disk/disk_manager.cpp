@@ -10,13 +10,22 @@
 //
 //===----------------------------------------------------------------------===//
 
+#include <fcntl.h>
 #include <sys/stat.h>
+#include <sys/uio.h>
+#include <unistd.h>
+#include <algorithm>
 #include <cassert>
+#include <cerrno>
+#include <climits>
+#include <cstdlib>
 #include <cstring>
 #include <iostream>
+#include <memory>
 #include <mutex>  // NOLINT
 #include <string>
 #include <thread>  // NOLINT
+#include <vector>
 
 #include "common/exception.h"
 #include "common/logger.h"
@@ -26,105 +35,513 @@ namespace bustub {
 
 static char *buffer_used;
 
+/** Layout of the header at the start of a database file, the rest of the header is zero. */
+struct DbFileHeader {
+  char magic_[8];
+  uint32_t version_;
+  uint32_t page_size_;
+  uint32_t flags_;
+};
+/** The pages are compressed, see DiskManagerCompressed. */
+static constexpr uint32_t DB_FILE_COMPRESSED = 1;
+static constexpr char DB_FILE_MAGIC[8] = {'B', 'U', 'S', 'T', 'U', 'B', 'D', 'B'};
+static constexpr uint32_t DB_FILE_VERSION = 1;
+
+namespace {
+/** A buffer suitable for O_DIRECT, used to bounce the data of callers whose buffers are not aligned. */
+auto MakeAlignedBuffer(size_t size) -> std::unique_ptr<char, decltype(&free)> {
+  auto *buffer = static_cast<char *>(aligned_alloc(DiskManager::DIRECT_IO_ALIGNMENT, size));
+  if (buffer == nullptr) {
+    throw Exception(ExceptionType::OUT_OF_MEMORY, "cannot allocate an aligned I/O buffer");
+  }
+  return {buffer, &free};
+}
+
+/** write until everything is written. @return false on an I/O error */
+auto WriteAll(int fd, const char *data, size_t size) -> bool {
+  while (size > 0) {
+    ssize_t written = write(fd, data, size);
+    if (written < 0) {
+      if (errno == EINTR) {
+        continue;
+      }
+      return false;
+    }
+    data += written;
+    size -= written;
+  }
+  return true;
+}
+
+/** pwritev until everything is written. @return false on an I/O error */
+auto PwritevAll(int fd, std::vector<iovec> &iov, size_t offset) -> bool {
+  size_t first = 0;
+  while (first < iov.size()) {
+    int count = static_cast<int>(std::min<size_t>(iov.size() - first, IOV_MAX));
+    ssize_t written = pwritev(fd, iov.data() + first, count, static_cast<off_t>(offset));
+    if (written < 0) {
+      if (errno == EINTR) {
+        continue;
+      }
+      return false;
+    }
+    offset += written;
+    // skip the buffers written completely, then the written part of the next one
+    while (first < iov.size() && static_cast<size_t>(written) >= iov[first].iov_len) {
+      written -= iov[first].iov_len;
+      first++;
+    }
+    if (written > 0) {
+      iov[first].iov_base = static_cast<char *>(iov[first].iov_base) + written;
+      iov[first].iov_len -= written;
+    }
+  }
+  return true;
+}
+}  // namespace
+
+auto DiskManager::PwriteAll(int fd, const char *data, size_t size, size_t offset) -> bool {
+  while (size > 0) {
+    ssize_t written = pwrite(fd, data, size, static_cast<off_t>(offset));
+    if (written < 0) {
+      if (errno == EINTR) {
+        continue;
+      }
+      return false;
+    }
+    data += written;
+    size -= written;
+    offset += written;
+  }
+  return true;
+}
+
+auto DiskManager::PreadFull(int fd, char *data, size_t size, size_t offset) -> ssize_t {
+  size_t total = 0;
+  while (total < size) {
+    ssize_t count = pread(fd, data + total, size - total, static_cast<off_t>(offset + total));
+    if (count < 0) {
+      if (errno == EINTR) {
+        continue;
+      }
+      return -1;
+    }
+    if (count == 0) {
+      break;
+    }
+    total += count;
+  }
+  return static_cast<ssize_t>(total);
+}
+
 /**
  * Constructor: open/create a single database file & log file
  * @input db_file: database file name
  */
-DiskManager::DiskManager(const std::string &db_file) : file_name_(db_file) {
+DiskManager::DiskManager(const std::string &db_file, size_t page_size, bool direct_io)
+    : DiskManager(db_file, page_size, direct_io, false) {}
+
+DiskManager::DiskManager(const std::string &db_file, size_t page_size, bool direct_io, bool compressed)
+    : page_size_(page_size), file_name_(db_file) {
+  CheckPageSize(page_size_);
   std::string::size_type n = file_name_.rfind('.');
   if (n == std::string::npos) {
     LOG_DEBUG("wrong file format");
     return;
   }
   log_name_ = file_name_.substr(0, n) + ".log";
+  fsm_name_ = file_name_.substr(0, n) + ".fsm";
+
+  // the log is only appended to, every write goes to its end
+  log_fd_ = open(log_name_.c_str(), O_RDWR | O_CREAT | O_APPEND, 0644);
+  if (log_fd_ < 0) {
+    throw Exception("can't open dblog file");
+  }
+
+  struct stat stat_buf;
+  bool db_file_created = stat(db_file.c_str(), &stat_buf) != 0;
+  int flags = O_RDWR | O_CREAT;
+#ifdef O_DIRECT
+  if (direct_io) {
+    // file systems such as tmpfs do not support O_DIRECT, the file is then opened for buffered I/O
+    db_fd_ = open(db_file.c_str(), flags | O_DIRECT, 0644);
+    direct_io_ = db_fd_ >= 0;
+  }
+#endif
+  if (db_fd_ < 0) {
+    db_fd_ = open(db_file.c_str(), flags, 0644);
+  }
+  if (db_fd_ < 0 || fstat(db_fd_, &stat_buf) != 0) {
+    throw Exception("can't open db file");
+  }
+  file_size_ = stat_buf.st_size;
+  buffer_used = nullptr;
+  InitFileHeader(db_file_created, compressed);
+  LoadAllocationBitmap(db_file_created);
+}
 
-  log_io_.open(log_name_, std::ios::binary | std::ios::in | std::ios::app | std::ios::out);
-  // directory or file does not exist
-  if (!log_io_.is_open()) {
-    log_io_.clear();
-    // create a new file
-    log_io_.open(log_name_, std::ios::binary | std::ios::trunc | std::ios::out | std::ios::in);
-    if (!log_io_.is_open()) {
-      throw Exception("can't open dblog file");
+void DiskManager::CheckPageSize(size_t page_size) {
+  if (page_size < BUSTUB_PAGE_SIZE || page_size > BUSTUB_MAX_PAGE_SIZE || (page_size & (page_size - 1)) != 0) {
+    throw Exception(ExceptionType::INVALID, "page size must be a power of two between " +
+                                                std::to_string(BUSTUB_PAGE_SIZE) + " and " +
+                                                std::to_string(BUSTUB_MAX_PAGE_SIZE));
+  }
+}
+
+/**
+ * A new (or empty) db file gets a header with the requested page size, an existing one keeps its own page size; an
+ * existing file without the magic is a legacy headerless file of BUSTUB_PAGE_SIZE pages
+ */
+void DiskManager::InitFileHeader(bool db_file_created, bool compressed) {
+  auto buffer = MakeAlignedBuffer(DB_FILE_HEADER_SIZE);
+  memset(buffer.get(), 0, DB_FILE_HEADER_SIZE);
+  auto *header = reinterpret_cast<DbFileHeader *>(buffer.get());
+  if (!db_file_created && file_size_ > 0) {
+    ssize_t read_count = PreadFull(db_fd_, buffer.get(), DB_FILE_HEADER_SIZE, 0);
+    if (read_count < 0) {
+      throw Exception("can't read db file header");
+    }
+    bool has_magic = static_cast<size_t>(read_count) >= sizeof(DB_FILE_MAGIC) &&
+                     memcmp(header->magic_, DB_FILE_MAGIC, sizeof(DB_FILE_MAGIC)) == 0;
+    if (!has_magic && !compressed && file_size_ % BUSTUB_PAGE_SIZE == 0) {
+      // written before the header existed: the pages start at offset 0
+      header_size_ = 0;
+      page_size_ = BUSTUB_PAGE_SIZE;
+      return;
+    }
+    if (read_count != static_cast<ssize_t>(DB_FILE_HEADER_SIZE) || !has_magic || header->version_ != DB_FILE_VERSION) {
+      throw Exception("db file has no valid header");
     }
+    CheckPageSize(header->page_size_);
+    if (((header->flags_ & DB_FILE_COMPRESSED) != 0) != compressed) {
+      throw Exception(compressed ? "db file is not compressed" : "db file is compressed");
+    }
+    page_size_ = header->page_size_;
+    return;
+  }
+  memcpy(header->magic_, DB_FILE_MAGIC, sizeof(DB_FILE_MAGIC));
+  header->version_ = DB_FILE_VERSION;
+  header->page_size_ = page_size_;
+  header->flags_ = compressed ? DB_FILE_COMPRESSED : 0;
+  if (pwrite(db_fd_, buffer.get(), DB_FILE_HEADER_SIZE, 0) != static_cast<ssize_t>(DB_FILE_HEADER_SIZE)) {
+    throw Exception("can't write db file header");
   }
+  file_size_ = std::max<size_t>(file_size_, DB_FILE_HEADER_SIZE);
+}
 
-  std::scoped_lock scoped_db_io_latch(db_io_latch_);
-  db_io_.open(db_file, std::ios::binary | std::ios::in | std::ios::out);
-  // directory or file does not exist
-  if (!db_io_.is_open()) {
-    db_io_.clear();
-    // create a new file
-    db_io_.open(db_file, std::ios::binary | std::ios::trunc | std::ios::out | std::ios::in);
-    if (!db_io_.is_open()) {
-      throw Exception("can't open db file");
+/**
+ * Read the allocation bitmap, or rebuild it from the length of the db file if the bitmap file is missing
+ */
+void DiskManager::LoadAllocationBitmap(bool db_file_created) {
+  std::scoped_lock scoped_allocation_latch(allocation_latch_);
+  // a bitmap left behind by a deleted db file does not describe the new one
+  int fsm_size = db_file_created ? 0 : GetFileSize(fsm_name_);
+  if (fsm_size > 0) {
+    fsm_io_.open(fsm_name_, std::ios::binary | std::ios::in | std::ios::out);
+    if (!fsm_io_.is_open()) {
+      throw Exception("can't open fsm file");
+    }
+    allocation_bitmap_.resize(fsm_size / sizeof(uint64_t));
+    fsm_io_.read(reinterpret_cast<char *>(allocation_bitmap_.data()), allocation_bitmap_.size() * sizeof(uint64_t));
+    for (size_t i = 0; i < allocation_bitmap_.size(); i++) {
+      if (allocation_bitmap_[i] != 0) {
+        num_pages_ = static_cast<page_id_t>(i * PAGES_PER_WORD + 64 - __builtin_clzll(allocation_bitmap_[i]));
+      }
+    }
+  } else {
+    fsm_io_.open(fsm_name_, std::ios::binary | std::ios::trunc | std::ios::out | std::ios::in);
+    if (!fsm_io_.is_open()) {
+      throw Exception("can't open fsm file");
     }
+    // every page already in the db file is in use
+    size_t db_size = file_size_;
+    size_t data_size = db_size > header_size_ ? db_size - header_size_ : 0;
+    num_pages_ = static_cast<page_id_t>((data_size + page_size_ - 1) / page_size_);
+    allocation_bitmap_.assign((num_pages_ + PAGES_PER_WORD - 1) / PAGES_PER_WORD, 0);
+    for (page_id_t page_id = 0; page_id < num_pages_; page_id++) {
+      allocation_bitmap_[page_id / PAGES_PER_WORD] |= uint64_t{1} << (page_id % PAGES_PER_WORD);
+    }
+    fsm_io_.write(reinterpret_cast<const char *>(allocation_bitmap_.data()),
+                  allocation_bitmap_.size() * sizeof(uint64_t));
+    fsm_io_.flush();
   }
-  buffer_used = nullptr;
+  while (first_free_word_ < allocation_bitmap_.size() && allocation_bitmap_[first_free_word_] == ~uint64_t{0}) {
+    first_free_word_++;
+  }
+  last_allocated_page_id_ = num_pages_ - 1;
+}
+
+void DiskManager::PersistAllocation(page_id_t page_id) {
+  if (!fsm_io_.is_open()) {
+    return;
+  }
+  size_t word = page_id / PAGES_PER_WORD;
+  fsm_io_.seekp(word * sizeof(uint64_t));
+  fsm_io_.write(reinterpret_cast<const char *>(&allocation_bitmap_[word]), sizeof(uint64_t));
+  if (fsm_io_.bad()) {
+    LOG_DEBUG("I/O error while writing fsm");
+    return;
+  }
+  fsm_io_.flush();
+}
+
+/**
+ * Allocate the hole after the last allocated page if there is one, otherwise the lowest free page; pages of segments
+ * come from their extents
+ */
+auto DiskManager::AllocatePage(page_id_t segment) -> page_id_t {
+  std::scoped_lock scoped_allocation_latch(allocation_latch_);
+  page_id_t page_id;
+  if (segment == INVALID_PAGE_ID) {
+    page_id = FindSharedPageLocked();
+    last_allocated_page_id_ = page_id;
+  } else if (segment == NEW_SEGMENT) {
+    // the first page of the new segment identifies it
+    size_t word = ClaimExtentLocked(INVALID_PAGE_ID);
+    page_id = static_cast<page_id_t>(word * PAGES_PER_WORD);
+    extent_owners_[word] = page_id;
+    segment_extents_[page_id] = word;
+  } else {
+    page_id = FindSegmentPageLocked(segment);
+  }
+  size_t word = page_id / PAGES_PER_WORD;
+  if (word >= allocation_bitmap_.size()) {
+    allocation_bitmap_.resize(word + 1, 0);
+  }
+  allocation_bitmap_[word] |= uint64_t{1} << (page_id % PAGES_PER_WORD);
+  num_pages_ = std::max(num_pages_, page_id + 1);
+  PersistAllocation(page_id);
+  return page_id;
+}
+
+auto DiskManager::FindSharedPageLocked() -> page_id_t {
+  page_id_t page_id = last_allocated_page_id_ + 1;
+  if (page_id < num_pages_ && !IsPageAllocatedLocked(page_id) &&
+      ExtentOwnerLocked(page_id / PAGES_PER_WORD) == INVALID_PAGE_ID) {
+    return page_id;
+  }
+  while (first_free_word_ < allocation_bitmap_.size() && allocation_bitmap_[first_free_word_] == ~uint64_t{0}) {
+    first_free_word_++;
+  }
+  size_t word = first_free_word_;
+  while (word < allocation_bitmap_.size() &&
+         (allocation_bitmap_[word] == ~uint64_t{0} || ExtentOwnerLocked(word) != INVALID_PAGE_ID)) {
+    word++;
+  }
+  page_id = static_cast<page_id_t>(word * PAGES_PER_WORD);
+  if (word < allocation_bitmap_.size()) {
+    page_id += __builtin_ctzll(~allocation_bitmap_[word]);
+  }
+  return page_id;
+}
+
+auto DiskManager::FindSegmentPageLocked(page_id_t segment) -> page_id_t {
+  size_t word = allocation_bitmap_.size();
+  auto it = segment_extents_.find(segment);
+  if (it != segment_extents_.end() && allocation_bitmap_[it->second] != ~uint64_t{0}) {
+    word = it->second;
+  } else {
+    // reuse a free page of an extent the segment already owns before claiming a new one
+    for (size_t i = 0; i < extent_owners_.size(); i++) {
+      if (extent_owners_[i] == segment && allocation_bitmap_[i] != ~uint64_t{0}) {
+        word = i;
+        break;
+      }
+    }
+    if (word == allocation_bitmap_.size()) {
+      word = ClaimExtentLocked(segment);
+    }
+    segment_extents_[segment] = word;
+  }
+  return static_cast<page_id_t>(word * PAGES_PER_WORD + __builtin_ctzll(~allocation_bitmap_[word]));
+}
+
+auto DiskManager::ClaimExtentLocked(page_id_t segment) -> size_t {
+  size_t word = first_free_word_;
+  while (word < allocation_bitmap_.size() &&
+         (allocation_bitmap_[word] != 0 || ExtentOwnerLocked(word) != INVALID_PAGE_ID)) {
+    word++;
+  }
+  if (word >= allocation_bitmap_.size()) {
+    allocation_bitmap_.resize(word + 1, 0);
+  }
+  if (word >= extent_owners_.size()) {
+    extent_owners_.resize(allocation_bitmap_.size(), INVALID_PAGE_ID);
+  }
+  extent_owners_[word] = segment;
+  return word;
+}
+
+void DiskManager::DeallocatePage(page_id_t page_id) {
+  std::scoped_lock scoped_allocation_latch(allocation_latch_);
+  if (!IsPageAllocatedLocked(page_id)) {
+    return;
+  }
+  size_t word = page_id / PAGES_PER_WORD;
+  allocation_bitmap_[word] &= ~(uint64_t{1} << (page_id % PAGES_PER_WORD));
+  first_free_word_ = std::min(first_free_word_, word);
+  if (page_id == last_allocated_page_id_) {
+    // the allocation was given back at once, the next one takes its place
+    last_allocated_page_id_--;
+  }
+  page_id_t segment = ExtentOwnerLocked(word);
+  if (segment != INVALID_PAGE_ID && allocation_bitmap_[word] == 0) {
+    // the extent is empty, it goes back to the shared pool
+    extent_owners_[word] = INVALID_PAGE_ID;
+    auto it = segment_extents_.find(segment);
+    if (it != segment_extents_.end() && it->second == word) {
+      segment_extents_.erase(it);
+    }
+  }
+  while (num_pages_ > 0 && !IsPageAllocatedLocked(num_pages_ - 1)) {
+    num_pages_--;
+  }
+  PersistAllocation(page_id);
+}
+
+auto DiskManager::IsPageAllocated(page_id_t page_id) -> bool {
+  std::scoped_lock scoped_allocation_latch(allocation_latch_);
+  return IsPageAllocatedLocked(page_id);
+}
+
+auto DiskManager::IsPageAllocatedLocked(page_id_t page_id) -> bool {
+  if (page_id < 0 || static_cast<size_t>(page_id / PAGES_PER_WORD) >= allocation_bitmap_.size()) {
+    return false;
+  }
+  return (allocation_bitmap_[page_id / PAGES_PER_WORD] >> (page_id % PAGES_PER_WORD) & 1) != 0;
+}
+
+auto DiskManager::GetNumPages() -> page_id_t {
+  std::scoped_lock scoped_allocation_latch(allocation_latch_);
+  return num_pages_;
 }
 
 /**
  * Close all file streams
  */
 void DiskManager::ShutDown() {
+  if (db_fd_ >= 0) {
+    close(db_fd_);
+    db_fd_ = -1;
+  }
   {
-    std::scoped_lock scoped_db_io_latch(db_io_latch_);
-    db_io_.close();
+    std::scoped_lock scoped_allocation_latch(allocation_latch_);
+    fsm_io_.close();
+  }
+  if (log_fd_ >= 0) {
+    close(log_fd_);
+    log_fd_ = -1;
+  }
+}
+
+DiskManager::~DiskManager() {
+  if (db_fd_ >= 0) {
+    close(db_fd_);
+  }
+  if (log_fd_ >= 0) {
+    close(log_fd_);
   }
-  log_io_.close();
 }
 
 /**
  * Write the contents of the specified page into disk file
  */
 void DiskManager::WritePage(page_id_t page_id, const char *page_data) {
-  std::scoped_lock scoped_db_io_latch(db_io_latch_);
-  size_t offset = static_cast<size_t>(page_id) * BUSTUB_PAGE_SIZE;
-  // set write cursor to offset
+  size_t offset = PageOffset(page_id);
   num_writes_ += 1;
-  db_io_.seekp(offset);
-  db_io_.write(page_data, BUSTUB_PAGE_SIZE);
-  // check for I/O error
-  if (db_io_.bad()) {
+  std::unique_ptr<char, decltype(&free)> bounce(nullptr, &free);
+  if (direct_io_ && !IsDirectIoAligned(page_data)) {
+    // O_DIRECT cannot write from this buffer, copy it
+    bounce = MakeAlignedBuffer(page_size_);
+    memcpy(bounce.get(), page_data, page_size_);
+    page_data = bounce.get();
+  }
+  if (!PwriteAll(db_fd_, page_data, page_size_, offset)) {
     LOG_DEBUG("I/O error while writing");
     return;
   }
-  // needs to flush to keep disk file in sync
-  db_io_.flush();
+  GrowFileSize(offset + page_size_);
+}
+
+/**
+ * Write the contents of consecutive pages into disk file, with one positional vectored write
+ */
+void DiskManager::WritePages(page_id_t first_page_id, const std::vector<const char *> &pages_data) {
+  size_t offset = PageOffset(first_page_id);
+  num_writes_ += 1;
+  std::vector<iovec> iov(pages_data.size());
+  std::unique_ptr<char, decltype(&free)> bounce(nullptr, &free);
+  for (size_t i = 0; i < pages_data.size(); i++) {
+    const char *page_data = pages_data[i];
+    if (direct_io_ && !IsDirectIoAligned(page_data)) {
+      // O_DIRECT cannot write from this buffer, copy it
+      if (bounce == nullptr) {
+        bounce = MakeAlignedBuffer(pages_data.size() * page_size_);
+      }
+      memcpy(bounce.get() + i * page_size_, page_data, page_size_);
+      page_data = bounce.get() + i * page_size_;
+    }
+    iov[i] = {const_cast<char *>(page_data), page_size_};
+  }
+  if (!PwritevAll(db_fd_, iov, offset)) {
+    LOG_DEBUG("I/O error while writing");
+    return;
+  }
+  GrowFileSize(offset + pages_data.size() * page_size_);
+}
+
+void DiskManager::ReadWritePages(const std::vector<PageIo> &ios) {
+  for (const auto &io : ios) {
+    if (io.is_write_) {
+      WritePage(io.page_id_, io.data_);
+    } else {
+      ReadPage(io.page_id_, io.data_);
+    }
+  }
+}
+
+void DiskManager::GrowFileSize(size_t end) {
+  size_t file_size = file_size_.load();
+  while (file_size < end && !file_size_.compare_exchange_weak(file_size, end)) {
+  }
 }
 
 /**
  * Read the contents of the specified page into the given memory area
  */
 void DiskManager::ReadPage(page_id_t page_id, char *page_data) {
-  std::scoped_lock scoped_db_io_latch(db_io_latch_);
-  int offset = page_id * BUSTUB_PAGE_SIZE;
+  size_t offset = PageOffset(page_id);
   // check if read beyond file length
-  if (offset > GetFileSize(file_name_)) {
+  if (offset >= file_size_) {
     LOG_DEBUG("I/O error reading past end of file");
-    // std::cerr << "I/O error while reading" << std::endl;
-  } else {
-    // set read cursor to offset
-    db_io_.seekp(offset);
-    db_io_.read(page_data, BUSTUB_PAGE_SIZE);
-    if (db_io_.bad()) {
-      LOG_DEBUG("I/O error while reading");
-      return;
-    }
-    // if file ends before reading BUSTUB_PAGE_SIZE
-    int read_count = db_io_.gcount();
-    if (read_count < BUSTUB_PAGE_SIZE) {
-      LOG_DEBUG("Read less than a page");
-      db_io_.clear();
-      // std::cerr << "Read less than a page" << std::endl;
-      memset(page_data + read_count, 0, BUSTUB_PAGE_SIZE - read_count);
-    }
+    memset(page_data, 0, page_size_);
+    return;
+  }
+  std::unique_ptr<char, decltype(&free)> bounce(nullptr, &free);
+  char *buffer = page_data;
+  if (direct_io_ && !IsDirectIoAligned(page_data)) {
+    // O_DIRECT cannot read into this buffer
+    bounce = MakeAlignedBuffer(page_size_);
+    buffer = bounce.get();
+  }
+  ssize_t read_count = PreadFull(db_fd_, buffer, page_size_, offset);
+  if (read_count < 0) {
+    LOG_DEBUG("I/O error while reading");
+    return;
+  }
+  if (buffer != page_data) {
+    memcpy(page_data, buffer, read_count);
+  }
+  // if file ends before reading a whole page
+  if (static_cast<size_t>(read_count) < page_size_) {
+    LOG_DEBUG("Read less than a page");
+    memset(page_data + read_count, 0, page_size_ - read_count);
   }
 }
 
 /**
  * Write the contents of the log into disk file
- * Only return when sync is done, and only perform sequence write
+ * Only return when sync is done (fdatasync), and only perform sequence write
  */
 void DiskManager::WriteLog(char *log_data, int size) {
   // enforce swap log buffer
@@ -144,15 +561,15 @@ void DiskManager::WriteLog(char *log_data, int size) {
 
   num_flushes_ += 1;
   // sequence write
-  log_io_.write(log_data, size);
-
-  // check for I/O error
-  if (log_io_.bad()) {
+  if (!WriteAll(log_fd_, log_data, size)) {
     LOG_DEBUG("I/O error while writing log");
     return;
   }
-  // needs to flush to keep disk file in sync
-  log_io_.flush();
+  // the log is durable only once it is on the disk, not in the page cache
+  if (fdatasync(log_fd_) != 0) {
+    LOG_DEBUG("I/O error while syncing log");
+    return;
+  }
   flush_log_ = false;
 }
 
@@ -167,17 +584,13 @@ auto DiskManager::ReadLog(char *log_data, int size, int offset) -> bool {
     // LOG_DEBUG("file size is %d", GetFileSize(log_name_));
     return false;
   }
-  log_io_.seekp(offset);
-  log_io_.read(log_data, size);
-
-  if (log_io_.bad()) {
+  ssize_t read_count = PreadFull(log_fd_, log_data, size, offset);
+  if (read_count < 0) {
     LOG_DEBUG("I/O error while reading log");
     return false;
   }
   // if log file ends before reading "size"
-  int read_count = log_io_.gcount();
   if (read_count < size) {
-    log_io_.clear();
     memset(log_data + read_count, 0, size - read_count);
   }
 
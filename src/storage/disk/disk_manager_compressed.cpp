@@ -0,0 +1,248 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// disk_manager_compressed.cpp
+//
+// Identification: src/storage/disk/disk_manager_compressed.cpp
+//
+// Copyright (c) 2015-2023, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#include "storage/disk/disk_manager_compressed.h"
+
+#include <fcntl.h>
+#include <unistd.h>
+#include <algorithm>
+#include <cstring>
+#include <iterator>
+#include <memory>
+#include <utility>
+
+#include "common/exception.h"
+#include "common/logger.h"
+#include "common/util/lz_util.h"
+
+namespace bustub {
+
+DiskManagerCompressed::DiskManagerCompressed(const std::string &db_file, size_t page_size)
+    : DiskManager(db_file, page_size, false, true) {
+  if (db_fd_ < 0) {
+    return;
+  }
+  map_name_ = file_name_.substr(0, file_name_.rfind('.')) + ".cmap";
+  LoadSlotMap();
+}
+
+DiskManagerCompressed::~DiskManagerCompressed() {
+  if (map_fd_ >= 0) {
+    close(map_fd_);
+  }
+}
+
+/**
+ * A map left behind by a deleted db file does not describe the new one, the db file has no slots yet
+ */
+void DiskManagerCompressed::LoadSlotMap() {
+  std::scoped_lock map_latch(map_latch_);
+  int flags = O_RDWR | O_CREAT;
+  if (file_size_ <= DB_FILE_HEADER_SIZE) {
+    flags |= O_TRUNC;
+  }
+  map_fd_ = open(map_name_.c_str(), flags, 0644);
+  if (map_fd_ < 0) {
+    throw Exception("can't open cmap file");
+  }
+  int map_size = GetFileSize(map_name_);
+  slot_map_.assign(std::max(map_size, 0) / sizeof(SlotEntry), SlotEntry{0, 0, 0});
+  size_t map_bytes = slot_map_.size() * sizeof(SlotEntry);
+  if (PreadFull(map_fd_, reinterpret_cast<char *>(slot_map_.data()), map_bytes, 0) !=
+      static_cast<ssize_t>(map_bytes)) {
+    throw Exception("can't read cmap file");
+  }
+
+  // the slots between the runs of the pages are free
+  std::vector<std::pair<uint32_t, uint32_t>> runs;
+  for (const auto &entry : slot_map_) {
+    if (entry.num_slots_ > 0) {
+      runs.emplace_back(entry.first_slot_, entry.num_slots_);
+      used_slots_ += entry.num_slots_;
+    }
+  }
+  std::sort(runs.begin(), runs.end());
+  for (const auto &[first_slot, num_slots] : runs) {
+    if (first_slot > end_slot_) {
+      free_runs_[end_slot_] = first_slot - end_slot_;
+    }
+    end_slot_ = std::max(end_slot_, first_slot + num_slots);
+  }
+  // a write which was not published before a crash left data past the last run
+  TruncateLocked();
+}
+
+auto DiskManagerCompressed::AllocateSlotsLocked(uint32_t num_slots) -> uint32_t {
+  for (auto it = free_runs_.begin(); it != free_runs_.end(); ++it) {
+    if (it->second < num_slots) {
+      continue;
+    }
+    uint32_t first_slot = it->first;
+    uint32_t rest = it->second - num_slots;
+    free_runs_.erase(it);
+    if (rest > 0) {
+      free_runs_[first_slot + num_slots] = rest;
+    }
+    return first_slot;
+  }
+  uint32_t first_slot = end_slot_;
+  end_slot_ += num_slots;
+  return first_slot;
+}
+
+void DiskManagerCompressed::FreeSlotsLocked(uint32_t first_slot, uint32_t num_slots) {
+  auto next = free_runs_.lower_bound(first_slot);
+  if (next != free_runs_.end() && next->first == first_slot + num_slots) {
+    num_slots += next->second;
+    next = free_runs_.erase(next);
+  }
+  if (next != free_runs_.begin()) {
+    auto prev = std::prev(next);
+    if (prev->first + prev->second == first_slot) {
+      first_slot = prev->first;
+      num_slots += prev->second;
+      free_runs_.erase(prev);
+    }
+  }
+  if (first_slot + num_slots == end_slot_) {
+    // the run is at the end of the file, the file shrinks instead
+    end_slot_ = first_slot;
+    TruncateLocked();
+    return;
+  }
+  free_runs_[first_slot] = num_slots;
+}
+
+void DiskManagerCompressed::TruncateLocked() {
+  size_t end = SlotOffset(end_slot_);
+  if (file_size_ <= end) {
+    return;
+  }
+  if (ftruncate(db_fd_, static_cast<off_t>(end)) != 0) {
+    LOG_DEBUG("I/O error while truncating");
+    return;
+  }
+  file_size_ = end;
+}
+
+void DiskManagerCompressed::PersistEntryLocked(page_id_t page_id) {
+  if (!PwriteAll(map_fd_, reinterpret_cast<const char *>(&slot_map_[page_id]), sizeof(SlotEntry),
+                 page_id * sizeof(SlotEntry))) {
+    LOG_DEBUG("I/O error while writing cmap");
+  }
+}
+
+/**
+ * Compress the page and write it to a new run of slots outside of the latch, then publish the run in the map and free
+ * the old one. The stored page is never overwritten, a crash in the middle of the write leaves the old page in place.
+ */
+void DiskManagerCompressed::WritePage(page_id_t page_id, const char *page_data) {
+  auto compressed = std::make_unique<char[]>(page_size_);
+  // a page which does not get smaller is stored as it is
+  size_t length = LzUtil::Compress(page_data, page_size_, compressed.get(), page_size_ - 1);
+  const char *data = compressed.get();
+  if (length == 0) {
+    length = page_size_;
+    data = page_data;
+  }
+  auto num_slots = static_cast<uint32_t>((length + SLOT_SIZE - 1) / SLOT_SIZE);
+
+  uint32_t first_slot;
+  {
+    std::scoped_lock map_latch(map_latch_);
+    first_slot = AllocateSlotsLocked(num_slots);
+  }
+  size_t offset = SlotOffset(first_slot);
+  num_writes_ += 1;
+  bool written = PwriteAll(db_fd_, data, length, offset);
+  if (written) {
+    GrowFileSize(offset + length);
+  } else {
+    LOG_DEBUG("I/O error while writing");
+  }
+
+  std::scoped_lock map_latch(map_latch_);
+  if (!written) {
+    FreeSlotsLocked(first_slot, num_slots);
+    return;
+  }
+  if (static_cast<size_t>(page_id) >= slot_map_.size()) {
+    slot_map_.resize(page_id + 1, SlotEntry{0, 0, 0});
+  }
+  SlotEntry old_entry = slot_map_[page_id];
+  slot_map_[page_id] = SlotEntry{first_slot, num_slots, static_cast<uint32_t>(length)};
+  PersistEntryLocked(page_id);
+  used_slots_ += num_slots;
+  if (old_entry.num_slots_ > 0) {
+    FreeSlotsLocked(old_entry.first_slot_, old_entry.num_slots_);
+    used_slots_ -= old_entry.num_slots_;
+  }
+}
+
+void DiskManagerCompressed::WritePages(page_id_t first_page_id, const std::vector<const char *> &pages_data) {
+  for (size_t i = 0; i < pages_data.size(); i++) {
+    WritePage(first_page_id + static_cast<page_id_t>(i), pages_data[i]);
+  }
+}
+
+/**
+ * Read the stored page and decompress it, a page which was never written reads as zeros
+ */
+void DiskManagerCompressed::ReadPage(page_id_t page_id, char *page_data) {
+  SlotEntry entry{0, 0, 0};
+  {
+    std::scoped_lock map_latch(map_latch_);
+    if (static_cast<size_t>(page_id) < slot_map_.size()) {
+      entry = slot_map_[page_id];
+    }
+  }
+  if (entry.length_ == 0) {
+    LOG_DEBUG("I/O error reading a page never written");
+    memset(page_data, 0, page_size_);
+    return;
+  }
+
+  size_t offset = SlotOffset(entry.first_slot_);
+  if (entry.length_ == page_size_) {
+    if (PreadFull(db_fd_, page_data, page_size_, offset) != static_cast<ssize_t>(page_size_)) {
+      LOG_WARN("I/O error while reading page %d", page_id);
+      memset(page_data, 0, page_size_);
+    }
+    return;
+  }
+  auto compressed = std::make_unique<char[]>(entry.length_);
+  if (PreadFull(db_fd_, compressed.get(), entry.length_, offset) != static_cast<ssize_t>(entry.length_) ||
+      LzUtil::Decompress(compressed.get(), entry.length_, page_data, page_size_) != page_size_) {
+    LOG_WARN("page %d is corrupted", page_id);
+    memset(page_data, 0, page_size_);
+  }
+}
+
+void DiskManagerCompressed::DeallocatePage(page_id_t page_id) {
+  DiskManager::DeallocatePage(page_id);
+  std::scoped_lock map_latch(map_latch_);
+  if (static_cast<size_t>(page_id) >= slot_map_.size() || slot_map_[page_id].length_ == 0) {
+    return;
+  }
+  SlotEntry &entry = slot_map_[page_id];
+  FreeSlotsLocked(entry.first_slot_, entry.num_slots_);
+  used_slots_ -= entry.num_slots_;
+  entry = SlotEntry{0, 0, 0};
+  PersistEntryLocked(page_id);
+}
+
+auto DiskManagerCompressed::GetStoredSize() -> size_t {
+  std::scoped_lock map_latch(map_latch_);
+  return used_slots_ * SLOT_SIZE;
+}
+
+}  // namespace bustub
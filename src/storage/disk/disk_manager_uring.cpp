@@ -0,0 +1,322 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// disk_manager_uring.cpp
+//
+// Identification: src/storage/disk/disk_manager_uring.cpp
+//
+// Copyright (c) 2015-2023, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#include "storage/disk/disk_manager_uring.h"
+
+#if defined(__linux__) && __has_include(<linux/io_uring.h>)
+#define BUSTUB_HAS_IO_URING
+#include <linux/io_uring.h>
+#include <sys/mman.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#endif
+
+#include <algorithm>
+#include <cerrno>
+#include <climits>
+#include <cstring>
+
+#include "common/exception.h"
+#include "common/logger.h"
+
+namespace bustub {
+
+#ifdef BUSTUB_HAS_IO_URING
+
+/**
+ * A minimal io_uring driven through the raw system calls: the submission queue, the completion queue and the array
+ * of submission queue entries are mapped from the kernel, entries are prepared at the tail of the submission queue
+ * and completions are reaped from the head of the completion queue. Not thread-safe, one thread uses a ring at a time.
+ */
+class DiskManagerUring::Ring {
+ public:
+  /** @return a ring with at least entries submission queue entries, nullptr if io_uring is unavailable */
+  static auto Create(unsigned entries) -> std::unique_ptr<Ring> {
+    io_uring_params params;
+    memset(&params, 0, sizeof(params));
+    int fd = static_cast<int>(syscall(__NR_io_uring_setup, entries, &params));
+    if (fd < 0) {
+      return nullptr;
+    }
+    std::unique_ptr<Ring> ring(new Ring(fd));
+    if (!ring->Map(params)) {
+      return nullptr;
+    }
+    return ring;
+  }
+
+  ~Ring() {
+    if (sqes_ != MAP_FAILED) {
+      munmap(sqes_, sqes_size_);
+    }
+    if (cq_ptr_ != MAP_FAILED && cq_ptr_ != sq_ptr_) {
+      munmap(cq_ptr_, cq_size_);
+    }
+    if (sq_ptr_ != MAP_FAILED) {
+      munmap(sq_ptr_, sq_size_);
+    }
+    close(fd_);
+  }
+
+  Ring(const Ring &) = delete;
+  auto operator=(const Ring &) -> Ring & = delete;
+
+  /** @return the number of requests the ring takes at once */
+  auto Capacity() const -> unsigned { return sq_entries_; }
+
+  /** Prepare a read or write at the tail of the submission queue, its result is reported under user_data. */
+  void Prepare(bool is_write, int fd, char *data, unsigned len, size_t offset, uint64_t user_data) {
+    io_uring_sqe *sqe = &sqes_[sq_tail_local_ & *sq_mask_];
+    memset(sqe, 0, sizeof(*sqe));
+    sqe->opcode = is_write ? IORING_OP_WRITE : IORING_OP_READ;
+    sqe->fd = fd;
+    sqe->addr = reinterpret_cast<uint64_t>(data);
+    sqe->len = len;
+    sqe->off = offset;
+    sqe->user_data = user_data;
+    sq_tail_local_++;
+    num_prepared_++;
+  }
+
+  /**
+   * Submit the prepared requests and wait for all of them. results[user_data] receives the result of every completed
+   * request: the number of bytes transferred or -errno.
+   * @return false if some requests could not be submitted, the ring must not be used again
+   */
+  auto SubmitAndWait(std::vector<int> *results) -> bool {
+    unsigned to_submit = num_prepared_;
+    num_prepared_ = 0;
+    __atomic_store_n(sq_tail_, sq_tail_local_, __ATOMIC_RELEASE);
+    unsigned submitted = 0;
+    unsigned completed = 0;
+    bool ok = true;
+    while (true) {
+      completed += Reap(results);
+      if (completed == submitted && (!ok || submitted == to_submit)) {
+        return ok;
+      }
+      unsigned submit_now = ok ? to_submit - submitted : 0;
+      // submit what is left and wait for a completion in the same system call
+      int ret = static_cast<int>(
+          syscall(__NR_io_uring_enter, fd_, submit_now, 1, IORING_ENTER_GETEVENTS, nullptr, static_cast<size_t>(0)));
+      if (ret < 0) {
+        if (errno == EINTR || errno == EAGAIN) {
+          continue;
+        }
+        if (submit_now == 0) {
+          throw Exception("io_uring_enter failed waiting for completions: " + std::string(strerror(errno)));
+        }
+        // the requests not taken by the kernel stay in the submission queue, wait only for the taken ones
+        ok = false;
+        continue;
+      }
+      if (ret == 0 && submit_now > 0 && submitted == completed) {
+        ok = false;
+        continue;
+      }
+      submitted += ret;
+    }
+  }
+
+ private:
+  explicit Ring(int fd) : fd_(fd) {}
+
+  auto Map(const io_uring_params &params) -> bool {
+    sq_entries_ = params.sq_entries;
+    sq_size_ = params.sq_off.array + params.sq_entries * sizeof(unsigned);
+    cq_size_ = params.cq_off.cqes + params.cq_entries * sizeof(io_uring_cqe);
+    bool single_mmap = (params.features & IORING_FEAT_SINGLE_MMAP) != 0;
+    if (single_mmap) {
+      sq_size_ = cq_size_ = std::max(sq_size_, cq_size_);
+    }
+    sq_ptr_ = mmap(nullptr, sq_size_, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, fd_, IORING_OFF_SQ_RING);
+    if (sq_ptr_ == MAP_FAILED) {
+      return false;
+    }
+    cq_ptr_ = single_mmap ? sq_ptr_
+                          : mmap(nullptr, cq_size_, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, fd_,
+                                 IORING_OFF_CQ_RING);
+    if (cq_ptr_ == MAP_FAILED) {
+      return false;
+    }
+    sqes_size_ = params.sq_entries * sizeof(io_uring_sqe);
+    sqes_ = static_cast<io_uring_sqe *>(
+        mmap(nullptr, sqes_size_, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, fd_, IORING_OFF_SQES));
+    if (sqes_ == MAP_FAILED) {
+      return false;
+    }
+    auto *sq = static_cast<char *>(sq_ptr_);
+    auto *cq = static_cast<char *>(cq_ptr_);
+    sq_tail_ = reinterpret_cast<unsigned *>(sq + params.sq_off.tail);
+    sq_mask_ = reinterpret_cast<unsigned *>(sq + params.sq_off.ring_mask);
+    cq_head_ = reinterpret_cast<unsigned *>(cq + params.cq_off.head);
+    cq_tail_ = reinterpret_cast<unsigned *>(cq + params.cq_off.tail);
+    cq_mask_ = reinterpret_cast<unsigned *>(cq + params.cq_off.ring_mask);
+    cqes_ = reinterpret_cast<io_uring_cqe *>(cq + params.cq_off.cqes);
+    // submission queue slot i always holds entry i, entries are consumed in order
+    auto *sq_array = reinterpret_cast<unsigned *>(sq + params.sq_off.array);
+    for (unsigned i = 0; i < sq_entries_; i++) {
+      sq_array[i] = i;
+    }
+    sq_tail_local_ = *sq_tail_;
+    return true;
+  }
+
+  /** @return the number of completions taken from the completion queue */
+  auto Reap(std::vector<int> *results) -> unsigned {
+    unsigned head = *cq_head_;
+    unsigned tail = __atomic_load_n(cq_tail_, __ATOMIC_ACQUIRE);
+    unsigned count = tail - head;
+    for (; head != tail; head++) {
+      const io_uring_cqe &cqe = cqes_[head & *cq_mask_];
+      (*results)[cqe.user_data] = cqe.res;
+    }
+    __atomic_store_n(cq_head_, head, __ATOMIC_RELEASE);
+    return count;
+  }
+
+  int fd_;
+  unsigned sq_entries_{0};
+  size_t sq_size_{0};
+  size_t cq_size_{0};
+  size_t sqes_size_{0};
+  void *sq_ptr_{MAP_FAILED};
+  void *cq_ptr_{MAP_FAILED};
+  io_uring_sqe *sqes_{static_cast<io_uring_sqe *>(MAP_FAILED)};
+  unsigned *sq_tail_{nullptr};
+  unsigned *sq_mask_{nullptr};
+  unsigned *cq_head_{nullptr};
+  unsigned *cq_tail_{nullptr};
+  unsigned *cq_mask_{nullptr};
+  io_uring_cqe *cqes_{nullptr};
+  // tail including the prepared, not yet published entries
+  unsigned sq_tail_local_{0};
+  unsigned num_prepared_{0};
+};
+
+#else
+
+/** Without io_uring no ring can be created, the disk manager always falls back to pread / pwrite. */
+class DiskManagerUring::Ring {
+ public:
+  static auto Create([[maybe_unused]] unsigned entries) -> std::unique_ptr<Ring> { return nullptr; }
+  auto Capacity() const -> unsigned { return 0; }
+  void Prepare([[maybe_unused]] bool is_write, [[maybe_unused]] int fd, [[maybe_unused]] char *data,
+               [[maybe_unused]] unsigned len, [[maybe_unused]] size_t offset, [[maybe_unused]] uint64_t user_data) {}
+  auto SubmitAndWait([[maybe_unused]] std::vector<int> *results) -> bool { return false; }
+};
+
+#endif
+
+DiskManagerUring::DiskManagerUring(const std::string &db_file, size_t page_size, bool direct_io, unsigned queue_depth)
+    : DiskManager(db_file, page_size, direct_io), queue_depth_(std::max(queue_depth, 1U)) {
+  if (db_fd_ < 0) {
+    return;
+  }
+  // probe io_uring with the first ring of the pool
+  auto ring = Ring::Create(queue_depth_);
+  if (ring == nullptr) {
+    LOG_WARN("io_uring is unavailable (%s), falling back to pread / pwrite", strerror(errno));
+    return;
+  }
+  uses_io_uring_ = true;
+  rings_.push_back(std::move(ring));
+}
+
+DiskManagerUring::~DiskManagerUring() = default;
+
+auto DiskManagerUring::AcquireRing() -> std::unique_ptr<Ring> {
+  {
+    std::scoped_lock lock(rings_latch_);
+    if (!rings_.empty()) {
+      auto ring = std::move(rings_.back());
+      rings_.pop_back();
+      return ring;
+    }
+  }
+  return Ring::Create(queue_depth_);
+}
+
+void DiskManagerUring::ReleaseRing(std::unique_ptr<Ring> ring) {
+  std::scoped_lock lock(rings_latch_);
+  rings_.push_back(std::move(ring));
+}
+
+auto DiskManagerUring::CanSubmit(const PageIo &io) const -> bool {
+  if (direct_io_ && !IsDirectIoAligned(io.data_)) {
+    return false;
+  }
+  // reads past the end of the file are served by zero-filling the page
+  return io.is_write_ || PageOffset(io.page_id_) < file_size_;
+}
+
+void DiskManagerUring::ReadWritePages(const std::vector<PageIo> &ios) {
+  if (!uses_io_uring_ || ios.size() <= 1) {
+    DiskManager::ReadWritePages(ios);
+    return;
+  }
+  auto ring = AcquireRing();
+  if (ring == nullptr) {
+    DiskManager::ReadWritePages(ios);
+    return;
+  }
+  std::vector<size_t> segment;
+  segment.reserve(ring->Capacity());
+  for (size_t i = 0; i < ios.size(); i++) {
+    const PageIo &io = ios[i];
+    bool same_page = std::any_of(segment.begin(), segment.end(),
+                                 [&](size_t j) { return ios[j].page_id_ == io.page_id_; });
+    bool submittable = ring != nullptr && CanSubmit(io);
+    // a segment completes in any order: a second request on a page, or a request executed synchronously, waits for
+    // the segment before it
+    if (!segment.empty() && (same_page || !submittable || segment.size() == ring->Capacity())) {
+      if (!RunSegment(ring.get(), ios, &segment)) {
+        ring.reset();
+      }
+      submittable = ring != nullptr && CanSubmit(io);
+    }
+    if (!submittable) {
+      DiskManager::ReadWritePages({io});
+      continue;
+    }
+    ring->Prepare(io.is_write_, db_fd_, io.data_, page_size_, PageOffset(io.page_id_), segment.size());
+    segment.push_back(i);
+  }
+  if (!segment.empty() && !RunSegment(ring.get(), ios, &segment)) {
+    ring.reset();
+  }
+  if (ring != nullptr) {
+    ReleaseRing(std::move(ring));
+  }
+}
+
+auto DiskManagerUring::RunSegment(Ring *ring, const std::vector<PageIo> &ios, std::vector<size_t> *segment) -> bool {
+  // INT_MIN marks the requests the ring did not complete
+  std::vector<int> results(segment->size(), INT_MIN);
+  bool ok = ring->SubmitAndWait(&results);
+  for (size_t k = 0; k < segment->size(); k++) {
+    const PageIo &io = ios[(*segment)[k]];
+    if (results[k] != static_cast<int>(page_size_)) {
+      // failed, short (end of file) or not submitted: pread / pwrite retry, zero-fill and report errors
+      DiskManager::ReadWritePages({io});
+      continue;
+    }
+    if (io.is_write_) {
+      num_writes_ += 1;
+      GrowFileSize(PageOffset(io.page_id_) + page_size_);
+    }
+  }
+  segment->clear();
+  return ok;
+}
+
+}  // namespace bustub
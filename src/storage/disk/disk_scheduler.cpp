@@ -0,0 +1,74 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// disk_scheduler.cpp
+//
+// Identification: src/storage/disk/disk_scheduler.cpp
+//
+// Copyright (c) 2015-2023, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#include "storage/disk/disk_scheduler.h"
+
+#include "common/exception.h"
+#include "common/macros.h"
+
+namespace bustub {
+
+DiskScheduler::DiskScheduler(DiskManager *disk_manager, size_t num_workers)
+    : disk_manager_(disk_manager), request_queues_(num_workers) {
+  BUSTUB_ENSURE(num_workers > 0, "disk scheduler needs at least one worker");
+  // Spawn the background threads
+  workers_.reserve(num_workers);
+  for (size_t i = 0; i < num_workers; ++i) {
+    workers_.emplace_back([&, i] { StartWorkerThread(i); });
+  }
+}
+
+DiskScheduler::~DiskScheduler() {
+  // Put a `std::nullopt` in every queue to signal the workers to exit the loop, the requests queued before are still
+  // served.
+  for (auto &queue : request_queues_) {
+    queue.Put(std::nullopt);
+  }
+  for (auto &worker : workers_) {
+    if (worker.joinable()) {
+      worker.join();
+    }
+  }
+}
+
+void DiskScheduler::Schedule(DiskRequest r) {
+  BUSTUB_ASSERT(r.page_id_ >= 0, "invalid page id");
+  request_queues_[r.page_id_ % request_queues_.size()].Put(std::move(r));
+}
+
+void DiskScheduler::StartWorkerThread(size_t idx) {
+  auto &queue = request_queues_[idx];
+  std::vector<DiskManager::PageIo> ios;
+  ios.reserve(DISK_IO_BATCH_SIZE);
+  bool stop = false;
+  while (!stop) {
+    // take the requests queued meanwhile together, the disk manager may submit them at once
+    auto requests = queue.GetBatch(DISK_IO_BATCH_SIZE);
+    ios.clear();
+    for (auto &request : requests) {
+      if (!request.has_value()) {
+        stop = true;
+        break;
+      }
+      ios.push_back({request->is_write_, request->page_id_, request->data_});
+    }
+    if (ios.empty()) {
+      break;
+    }
+    disk_manager_->ReadWritePages(ios);
+    for (size_t i = 0; i < ios.size(); i++) {
+      requests[i]->callback_.set_value(true);
+    }
+  }
+}
+
+}  // namespace bustub
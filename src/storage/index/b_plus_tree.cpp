@@ -14,9 +14,12 @@ BPLUSTREE_TYPE::BPlusTree(std::string name, page_id_t header_page_id, BufferPool
     : index_name_(std::move(name)),
       bpm_(buffer_pool_manager),
       comparator_(std::move(comparator)),
-      leaf_max_size_(leaf_max_size),
-      internal_max_size_(internal_max_size),
+      leaf_max_size_(leaf_max_size > 0 ? leaf_max_size : LeafPage::Capacity(bpm_->GetPageSize())),
+      internal_max_size_(internal_max_size > 0 ? internal_max_size : InternalPage::Capacity(bpm_->GetPageSize()) - 1),
       header_page_id_(header_page_id) {
+  BUSTUB_ENSURE(leaf_max_size_ <= LeafPage::Capacity(bpm_->GetPageSize()) &&
+                    internal_max_size_ < InternalPage::Capacity(bpm_->GetPageSize()),
+                "b+ tree pages do not fit in the pages of the buffer pool");
   WritePageGuard guard = bpm_->FetchPageWrite(header_page_id_);
   auto root_page = guard.AsMut<BPlusTreeHeaderPage>();
   root_page->root_page_id_ = INVALID_PAGE_ID;
@@ -71,6 +74,15 @@ void BPLUSTREE_TYPE::FindPath(const KeyType &key, Context& ctx, bool write, Tran
 
     // page_id_t root_page_id = GetRootPageId();
 
+    if(!write){
+        // 读的方式先乐观地下降，失败几次后再退回到加读锁的方式
+        for(int attempt = 0; attempt < OPTIMISTIC_DESCENT_ATTEMPTS; attempt++){
+            if(FindLeafOptimistic(key, ctx)){
+                return;
+            }
+        }
+    }
+
     ReadPageGuard header_page_guard;    // 默认空
     const BPlusTreeHeaderPage* header_page = nullptr;
 
@@ -151,6 +163,111 @@ void BPLUSTREE_TYPE::FindPath(const KeyType &key, Context& ctx, bool write, Tran
 
 
 
+INDEX_TEMPLATE_ARGUMENTS
+auto BPLUSTREE_TYPE::DescendOptimistic(const KeyType &key, Context &ctx, OptimisticPageGuard *leaf) -> bool {
+    // 内部节点最多能放下的kv对数，乐观读到的size可能是被修改到一半的值，用它来检查越界
+    const int internal_capacity = InternalPage::Capacity(bpm_->GetPageSize());
+
+    ctx.write_set_.clear();
+    ctx.read_set_.clear();
+
+    OptimisticPageGuard parent = bpm_->FetchPageOptimistic(header_page_id_);
+    if(!parent.IsValid()){
+        return false;
+    }
+    page_id_t page_id = parent.As<BPlusTreeHeaderPage>()->root_page_id_;
+    if(!parent.Validate()){
+        return false;
+    }
+    ctx.root_page_id_ = page_id;
+    if(page_id == INVALID_PAGE_ID){
+        // 空B+树
+        return true;
+    }
+
+    while(true){
+        OptimisticPageGuard node = bpm_->FetchPageOptimistic(page_id);
+        // 读到孩子的版本号之后再校验父节点，确认孩子的page id是从一致的父节点中读到的
+        if(!node.IsValid() || !parent.Validate()){
+            return false;
+        }
+        const BPlusTreePage* page = node.As<BPlusTreePage>();
+
+        if(page->IsLeafPage()){
+            *leaf = node;
+            return true;
+        }
+
+        const InternalPage* internal_page = reinterpret_cast<const InternalPage *>(page);
+        int size = internal_page->GetSize();
+        if(size < 2 || size > internal_capacity){
+            // 读到了修改中的数据
+            return false;
+        }
+        page_id_t child_page_id = internal_page->LookupChild(key, comparator_, size);
+        if(!node.Validate()){
+            return false;
+        }
+        parent = node;
+        page_id = child_page_id;
+    }
+}
+
+INDEX_TEMPLATE_ARGUMENTS
+auto BPLUSTREE_TYPE::FindLeafOptimistic(const KeyType &key, Context &ctx) -> bool {
+    OptimisticPageGuard leaf;
+    if(!DescendOptimistic(key, ctx, &leaf)){
+        return false;
+    }
+    if(ctx.root_page_id_ == INVALID_PAGE_ID){
+        return true;
+    }
+    // 叶子节点加读锁，加锁后版本号不变，说明叶子从父节点校验之后没有被修改过
+    ReadPageGuard leaf_guard = bpm_->FetchPageRead(leaf.PageId());
+    if(!leaf.Validate()){
+        return false;
+    }
+    ctx.read_set_.push_back(std::move(leaf_guard));
+    return true;
+}
+
+INDEX_TEMPLATE_ARGUMENTS
+auto BPLUSTREE_TYPE::FindLeafOptimisticWrite(const KeyType &key, Context &ctx, bool insert) -> bool {
+    for(int attempt = 0; attempt < OPTIMISTIC_DESCENT_ATTEMPTS; attempt++){
+        OptimisticPageGuard leaf;
+        if(!DescendOptimistic(key, ctx, &leaf)){
+            continue;
+        }
+        if(ctx.root_page_id_ == INVALID_PAGE_ID){
+            // 空树要修改header page中的根
+            return false;
+        }
+        // 叶子先加upgrade锁，读者仍可以读它；确认版本号不变之后再判断这次修改是否只涉及叶子
+        UpgradablePageGuard leaf_guard = bpm_->FetchPageUpgradable(leaf.PageId());
+        if(!leaf.Validate()){
+            continue;
+        }
+        const LeafPage* leaf_page = leaf_guard.As<LeafPage>();
+        bool safe = false;
+        if(insert){
+            // 插入后达到max size就要分裂
+            safe = leaf_page->GetSize() + 1 < leaf_page->GetMaxSize();
+        }else if(ctx.IsRootPage(leaf.PageId())){
+            // 根叶子被删空时要修改header page
+            safe = leaf_page->GetSize() > 1;
+        }else{
+            // 删除后低于min size就要拆借或合并
+            safe = leaf_page->GetSize() > leaf_page->GetMinSize();
+        }
+        if(!safe){
+            return false;
+        }
+        ctx.write_set_.push_back(leaf_guard.Upgrade());
+        return true;
+    }
+    return false;
+}
+
 /*****************************************************************************
  * INSERTION
  *****************************************************************************/
@@ -169,12 +286,15 @@ auto BPLUSTREE_TYPE::Insert(const KeyType &key, const ValueType &value, Transact
 
     Context context;
 
-    FindPath(key, context, true);  // 写的方式寻找路径。
+    // 先乐观地下降，只给叶子加写锁；叶子会分裂时再从header page开始加写锁寻找路径
+    if(!FindLeafOptimisticWrite(key, context, true)){
+        FindPath(key, context, true);  // 写的方式寻找路径。
+    }
 
     if(context.root_page_id_ == INVALID_PAGE_ID){
         // 空B+树
         page_id_t new_page_id = INVALID_PAGE_ID;
-        BasicPageGuard new_page_guard = bpm_->NewPageGuarded(&new_page_id);
+        BasicPageGuard new_page_guard = bpm_->NewPageGuarded(&new_page_id, header_page_id_);
 
         if(new_page_id == INVALID_PAGE_ID){
             // out of memory
@@ -204,8 +324,9 @@ auto BPLUSTREE_TYPE::Insert(const KeyType &key, const ValueType &value, Transact
     // leaf_page插入后判断大小
     if(leaf_page->Insert(key, value, comparator_) >= leaf_page->GetMaxSize()){
       // 满了，将进行split
+      BUSTUB_ASSERT(context.header_page_.has_value(), "optimistic insert splits its leaf");
       page_id_t new_page_id = INVALID_PAGE_ID;
-      BasicPageGuard new_page_guard = bpm_->NewPageGuarded(&new_page_id);
+      BasicPageGuard new_page_guard = bpm_->NewPageGuarded(&new_page_id, header_page_id_);
 
       if(new_page_id == INVALID_PAGE_ID){
           // out of memory
@@ -265,7 +386,7 @@ void BPLUSTREE_TYPE::InsertInParent(page_id_t left_child, KeyType key, page_id_t
         continue;
       }
       page_id_t new_page_id = INVALID_PAGE_ID;
-      BasicPageGuard new_page_guard = bpm_->NewPageGuarded(&new_page_id);
+      BasicPageGuard new_page_guard = bpm_->NewPageGuarded(&new_page_id, header_page_id_);
       key = internal_page->KeyAt(mid);
       left_child = page_guard.PageId();
       right_child = new_page_id;
@@ -293,7 +414,7 @@ void BPLUSTREE_TYPE::InsertInParent(page_id_t left_child, KeyType key, page_id_t
 INDEX_TEMPLATE_ARGUMENTS
 void BPLUSTREE_TYPE::ChangeRoot(page_id_t left_child, KeyType key, page_id_t right_child, Context &ctx){
     page_id_t new_page_id = INVALID_PAGE_ID;
-    BasicPageGuard new_page_guard = bpm_->NewPageGuarded(&new_page_id);
+    BasicPageGuard new_page_guard = bpm_->NewPageGuarded(&new_page_id, header_page_id_);
 
     if(new_page_id == INVALID_PAGE_ID){
         // out of memory
@@ -325,7 +446,10 @@ void BPLUSTREE_TYPE::Remove(const KeyType &key, Transaction *txn) {
   Context ctx;
   (void)ctx;
 
-  FindPath(key, ctx, true);
+  // 先乐观地下降，只给叶子加写锁；叶子会拆借、合并或被删空时再从header page开始加写锁寻找路径
+  if(!FindLeafOptimisticWrite(key, ctx, false)){
+    FindPath(key, ctx, true);
+  }
 
   if(ctx.root_page_id_ == INVALID_PAGE_ID){
     // 空B+树
@@ -76,6 +76,26 @@ auto B_PLUS_TREE_INTERNAL_PAGE_TYPE::KeyIndex(const KeyType &key, const KeyCompa
   return end;
 }
 
+INDEX_TEMPLATE_ARGUMENTS
+auto B_PLUS_TREE_INTERNAL_PAGE_TYPE::LookupChild(const KeyType &key, const KeyComparator &comparator, int size) const -> ValueType{
+  int begin = 1, end = size;
+
+  while(begin < end){
+    int mid = (begin + end) / 2;
+
+    if(comparator(array_[mid].first, key) < 0){
+      begin = mid + 1;
+    }else{
+      end = mid;
+    }
+  }
+
+  if(end < size && comparator(array_[end].first, key) == 0){
+    return array_[end].second;
+  }
+  return array_[end - 1].second;
+}
+
 INDEX_TEMPLATE_ARGUMENTS
 auto B_PLUS_TREE_INTERNAL_PAGE_TYPE::Insert(const ValueType& left_child , const KeyType &key, const ValueType &right_child, const KeyComparator &comparator) -> int{
 
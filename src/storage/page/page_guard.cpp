@@ -95,4 +95,39 @@ WritePageGuard::~WritePageGuard() {
     Drop();
 }  // NOLINT
 
+UpgradablePageGuard::UpgradablePageGuard(UpgradablePageGuard &&that) noexcept
+    : guard_(std::move(that.guard_)), locked_(that.locked_) {
+    that.locked_ = false;
+}
+
+auto UpgradablePageGuard::operator=(UpgradablePageGuard &&that) noexcept -> UpgradablePageGuard & {
+    Drop();
+
+    locked_ = that.locked_;
+    guard_ = std::move(that.guard_);
+
+    that.locked_ = false;
+    return *this;
+}
+
+void UpgradablePageGuard::Drop() {
+    if (locked_) {
+        locked_ = false;
+        guard_.page_->UUnlatch();
+    }
+    guard_.Drop();
+}
+
+UpgradablePageGuard::~UpgradablePageGuard() {
+    Drop();
+}  // NOLINT
+
+auto UpgradablePageGuard::Upgrade() -> WritePageGuard {
+    BUSTUB_ASSERT(locked_, "upgrading an empty guard");
+    // 升级期间其他写者和升级者拿不到upgrade_mutex_，页的内容不会变
+    guard_.page_->UpgradeLatch();
+    locked_ = false;
+    return WritePageGuard(std::move(guard_));
+}
+
 }  // namespace bustub
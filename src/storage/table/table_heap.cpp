@@ -27,8 +27,8 @@
 namespace bustub {
 
 TableHeap::TableHeap(BufferPoolManager *bpm) : bpm_(bpm) {
-  // Initialize the first table page.
-  auto guard = bpm->NewPageGuarded(&first_page_id_);
+  // Initialize the first table page, it starts the segment of the table.
+  auto guard = bpm->NewPageGuarded(&first_page_id_, NEW_SEGMENT);
   last_page_id_ = first_page_id_;
   auto first_page = guard.AsMut<TablePage>();
   BUSTUB_ASSERT(first_page != nullptr,
@@ -42,7 +42,7 @@ auto TableHeap::InsertTuple(const TupleMeta &meta, const Tuple &tuple, LockManag
   auto page_guard = bpm_->FetchPageWrite(last_page_id_);
   while (true) {
     auto page = page_guard.AsMut<TablePage>();
-    if (page->GetNextTupleOffset(meta, tuple) != std::nullopt) {
+    if (page->GetNextTupleOffset(meta, tuple, bpm_->GetPageSize()) != std::nullopt) {
       break;
     }
 
@@ -50,7 +50,7 @@ auto TableHeap::InsertTuple(const TupleMeta &meta, const Tuple &tuple, LockManag
     BUSTUB_ENSURE(page->GetNumTuples() != 0, "tuple is too large, cannot insert");
 
     page_id_t next_page_id = INVALID_PAGE_ID;
-    auto npg = bpm_->NewPage(&next_page_id);
+    auto npg = bpm_->NewPage(&next_page_id, first_page_id_);
     BUSTUB_ENSURE(next_page_id != INVALID_PAGE_ID, "cannot allocate page");
 
     page->SetNextPageId(next_page_id);
@@ -70,7 +70,7 @@ auto TableHeap::InsertTuple(const TupleMeta &meta, const Tuple &tuple, LockManag
   auto last_page_id = last_page_id_;
 
   auto page = page_guard.AsMut<TablePage>();
-  auto slot_id = *page->InsertTuple(meta, tuple);
+  auto slot_id = *page->InsertTuple(meta, tuple, bpm_->GetPageSize());
 
   // only allow one insertion at a time, otherwise it will deadlock.
   guard.unlock();
@@ -0,0 +1,95 @@
+/**
+ * arc_replacer_test.cpp
+ */
+
+#include "buffer/arc_replacer.h"
+
+#include <vector>
+
+#include "gtest/gtest.h"
+
+namespace bustub {
+
+TEST(ARCReplacerTest, SampleTest) {
+  ARCReplacer arc_replacer(4);
+
+  // Scenario: frames 0-3 hold pages 10-13, seen once each, so all of them are in T1.
+  for (frame_id_t frame_id = 0; frame_id < 4; frame_id++) {
+    arc_replacer.RecordAccess(frame_id, AccessType::Unknown, 10 + frame_id);
+    arc_replacer.SetEvictable(frame_id, true);
+  }
+  ASSERT_EQ(4, arc_replacer.Size());
+  EXPECT_EQ(0, arc_replacer.TargetT1Size());
+
+  // Scenario: a second access promotes frame 0 to T2, T1 is above its target so it loses its oldest frames.
+  arc_replacer.RecordAccess(0, AccessType::Unknown, 10);
+  EXPECT_EQ((std::vector<frame_id_t>{1, 2, 3, 0}), arc_replacer.EvictionCandidates(4));
+  int value;
+  ASSERT_TRUE(arc_replacer.Evict(&value));
+  EXPECT_EQ(1, value);
+  ASSERT_TRUE(arc_replacer.Evict(&value));
+  EXPECT_EQ(2, value);
+  EXPECT_EQ(2, arc_replacer.Size());
+
+  // Scenario: page 11 comes back while it is remembered in B1. T1 was too small: its target grows and the page goes
+  // straight to T2.
+  arc_replacer.RecordAccess(1, AccessType::Unknown, 11);
+  arc_replacer.SetEvictable(1, true);
+  EXPECT_EQ(1, arc_replacer.TargetT1Size());
+
+  // Scenario: T1 = [3] is at its target, so the victim is the least recently used frame of T2.
+  ASSERT_TRUE(arc_replacer.Evict(&value));
+  EXPECT_EQ(0, value);
+
+  // Scenario: page 10 comes back while it is remembered in B2, T1 shrinks back.
+  arc_replacer.RecordAccess(0, AccessType::Unknown, 10);
+  arc_replacer.SetEvictable(0, true);
+  EXPECT_EQ(0, arc_replacer.TargetT1Size());
+
+  // Scenario: pinned frames are skipped, T2 is used when nothing in T1 is evictable.
+  arc_replacer.SetEvictable(3, false);
+  EXPECT_EQ(2, arc_replacer.Size());
+  ASSERT_TRUE(arc_replacer.Evict(&value));
+  EXPECT_EQ(1, value);
+  ASSERT_TRUE(arc_replacer.Evict(&value));
+  EXPECT_EQ(0, value);
+  EXPECT_FALSE(arc_replacer.Evict(&value));
+
+  // Scenario: removing a frame does not remember its page.
+  arc_replacer.SetEvictable(3, true);
+  arc_replacer.Remove(3);
+  EXPECT_EQ(0, arc_replacer.Size());
+  arc_replacer.RecordAccess(3, AccessType::Unknown, 13);
+  arc_replacer.SetEvictable(3, true);
+  EXPECT_EQ(0, arc_replacer.TargetT1Size());
+  ASSERT_TRUE(arc_replacer.Evict(&value));
+  EXPECT_EQ(3, value);
+}
+
+TEST(ARCReplacerTest, ScanResistanceTest) {
+  const size_t num_frames = 8;
+  ARCReplacer arc_replacer(num_frames);
+
+  // Scenario: frames 0-3 hold hot pages that are accessed twice.
+  for (frame_id_t frame_id = 0; frame_id < 4; frame_id++) {
+    arc_replacer.RecordAccess(frame_id, AccessType::Unknown, frame_id);
+    arc_replacer.RecordAccess(frame_id, AccessType::Unknown, frame_id);
+    arc_replacer.SetEvictable(frame_id, true);
+  }
+
+  // Scenario: a long scan only touches every page once, the scanned pages keep replacing each other in T1.
+  page_id_t next_page_id = 100;
+  for (frame_id_t frame_id = 4; frame_id < static_cast<frame_id_t>(num_frames); frame_id++) {
+    arc_replacer.RecordAccess(frame_id, AccessType::Scan, next_page_id++);
+    arc_replacer.SetEvictable(frame_id, true);
+  }
+  for (int i = 0; i < 100; i++) {
+    int value;
+    ASSERT_TRUE(arc_replacer.Evict(&value));
+    EXPECT_GE(value, 4);
+    arc_replacer.RecordAccess(value, AccessType::Scan, next_page_id++);
+    arc_replacer.SetEvictable(value, true);
+  }
+}
+
+}  // namespace bustub
@@ -12,14 +12,41 @@
 
 #include "buffer/buffer_pool_manager.h"
 
+#include <atomic>
+#include <chrono>  // NOLINT
 #include <cstdio>
 #include <random>
 #include <string>
+#include <thread>  // NOLINT
+#include <vector>
 
 #include "gtest/gtest.h"
+#include "storage/disk/disk_manager_memory.h"
 
 namespace bustub {
 
+/** An in-memory disk manager that counts the reads and writes reaching the disk. */
+class CountingDiskManager : public DiskManagerUnlimitedMemory {
+ public:
+  void ReadPage(page_id_t page_id, char *page_data) override {
+    num_reads_++;
+    DiskManagerUnlimitedMemory::ReadPage(page_id, page_data);
+  }
+  void WritePage(page_id_t page_id, const char *page_data) override {
+    num_write_calls_++;
+    num_pages_written_++;
+    DiskManagerUnlimitedMemory::WritePage(page_id, page_data);
+  }
+  void WritePages(page_id_t first_page_id, const std::vector<const char *> &pages_data) override {
+    num_write_calls_++;
+    num_pages_written_ += pages_data.size();
+    DiskManagerUnlimitedMemory::WritePages(first_page_id, pages_data);
+  }
+  std::atomic<int> num_reads_{0};
+  std::atomic<int> num_write_calls_{0};
+  std::atomic<int> num_pages_written_{0};
+};
+
 // NOLINTNEXTLINE
 // Check whether pages containing terminal characters can be recovered
 TEST(BufferPoolManagerTest, BinaryDataTest) {
@@ -144,4 +171,770 @@ TEST(BufferPoolManagerTest, SampleTest) {
   delete disk_manager;
 }
 
+// NOLINTNEXTLINE
+TEST(BufferPoolManagerTest, PartitionTest) {
+  const std::string db_name = "test.db";
+  const size_t buffer_pool_size = 10;
+  const size_t k = 5;
+  const size_t num_instances = 2;
+
+  auto *disk_manager = new DiskManager(db_name);
+  auto *bpm = new BufferPoolManager(buffer_pool_size, disk_manager, k, nullptr, num_instances);
+  EXPECT_EQ(num_instances, bpm->GetNumInstances());
+
+  // Scenario: Every partition owns half of the frames, so we can still fill up the whole buffer pool.
+  page_id_t page_id_temp;
+  for (size_t i = 0; i < buffer_pool_size; ++i) {
+    auto *page = bpm->NewPage(&page_id_temp);
+    ASSERT_NE(nullptr, page);
+    EXPECT_EQ(static_cast<page_id_t>(i), page_id_temp);
+    snprintf(page->GetData(), BUSTUB_PAGE_SIZE, "page %d", page_id_temp);
+  }
+  EXPECT_EQ(nullptr, bpm->NewPage(&page_id_temp));
+
+  // Scenario: Unpinning an even page only frees a frame of the first partition, which cannot be used by the second.
+  EXPECT_EQ(true, bpm->UnpinPage(0, true));
+  EXPECT_NE(nullptr, bpm->NewPage(&page_id_temp));
+  EXPECT_EQ(10, page_id_temp);
+  EXPECT_EQ(nullptr, bpm->NewPage(&page_id_temp));
+
+  // Scenario: Pages written back by one partition can be fetched again once a frame is available.
+  for (page_id_t page_id = 1; page_id < static_cast<page_id_t>(buffer_pool_size); ++page_id) {
+    EXPECT_EQ(true, bpm->UnpinPage(page_id, true));
+  }
+  EXPECT_EQ(true, bpm->UnpinPage(10, false));
+  for (page_id_t page_id = 0; page_id < static_cast<page_id_t>(buffer_pool_size); ++page_id) {
+    auto *page = bpm->FetchPage(page_id);
+    ASSERT_NE(nullptr, page);
+    EXPECT_EQ(0, strcmp(page->GetData(), ("page " + std::to_string(page_id)).c_str()));
+    EXPECT_EQ(true, bpm->UnpinPage(page_id, false));
+  }
+
+  disk_manager->ShutDown();
+  remove("test.db");
+
+  delete bpm;
+  delete disk_manager;
+}
+
+// NOLINTNEXTLINE
+TEST(BufferPoolManagerTest, MissDoesNotBlockHitTest) {
+  const size_t buffer_pool_size = 4;
+  const size_t k = 2;
+
+  auto disk_manager = std::make_unique<DiskManagerUnlimitedMemory>();
+  auto bpm = std::make_unique<BufferPoolManager>(buffer_pool_size, disk_manager.get(), k);
+
+  std::vector<page_id_t> page_ids;
+  for (size_t i = 0; i < buffer_pool_size * 2; ++i) {
+    page_id_t page_id;
+    auto *page = bpm->NewPage(&page_id);
+    ASSERT_NE(nullptr, page);
+    snprintf(page->GetData(), BUSTUB_PAGE_SIZE, "page %d", page_id);
+    bpm->UnpinPage(page_id, true);
+    page_ids.push_back(page_id);
+  }
+  // The last pages are resident, the first ones have been written back.
+  disk_manager->SetLatency(500);
+
+  std::atomic<bool> miss_done{false};
+  std::thread miss_thread([&] {
+    auto *page = bpm->FetchPage(page_ids[0]);
+    ASSERT_NE(nullptr, page);
+    EXPECT_EQ(0, strcmp(page->GetData(), "page 0"));
+    miss_done = true;
+    bpm->UnpinPage(page_ids[0], false);
+  });
+
+  // Scenario: while the miss is reading from disk, a hit on a resident page must not wait for it.
+  std::this_thread::sleep_for(std::chrono::milliseconds(100));
+  auto *hit_page = bpm->FetchPage(page_ids.back());
+  ASSERT_NE(nullptr, hit_page);
+  EXPECT_FALSE(miss_done.load());
+  bpm->UnpinPage(page_ids.back(), false);
+
+  // Scenario: a concurrent fetch of the page being read waits for that frame and sees the loaded data.
+  auto *same_page = bpm->FetchPage(page_ids[0]);
+  ASSERT_NE(nullptr, same_page);
+  EXPECT_EQ(0, strcmp(same_page->GetData(), "page 0"));
+  bpm->UnpinPage(page_ids[0], false);
+
+  miss_thread.join();
+}
+
+// NOLINTNEXTLINE
+TEST(BufferPoolManagerTest, BackgroundFlushTest) {
+  const std::string db_name = "test.db";
+  const size_t buffer_pool_size = 10;
+  const size_t clean_reserve = 4;
+  const size_t k = 2;
+
+  auto *disk_manager = new DiskManager(db_name);
+  auto *bpm = new BufferPoolManager(buffer_pool_size, disk_manager, k);
+
+  std::vector<page_id_t> page_ids;
+  for (size_t i = 0; i < buffer_pool_size; ++i) {
+    page_id_t page_id;
+    auto *page = bpm->NewPage(&page_id);
+    ASSERT_NE(nullptr, page);
+    snprintf(page->GetData(), BUSTUB_PAGE_SIZE, "page %d", page_id);
+    bpm->UnpinPage(page_id, true);
+    page_ids.push_back(page_id);
+  }
+  ASSERT_EQ(0, disk_manager->GetNumWrites());
+
+  // Scenario: the flusher writes back the coldest dirty frames, and only as many as the reserve asks for.
+  bpm->StartBackgroundFlush(clean_reserve);
+  for (int i = 0; i < 100 && disk_manager->GetNumWrites() < static_cast<int>(clean_reserve); ++i) {
+    std::this_thread::sleep_for(std::chrono::milliseconds(10));
+  }
+  std::this_thread::sleep_for(std::chrono::milliseconds(50));
+  ASSERT_EQ(static_cast<int>(clean_reserve), disk_manager->GetNumWrites());
+  for (size_t i = 0; i < buffer_pool_size; ++i) {
+    auto *page = bpm->FetchPage(page_ids[i]);
+    ASSERT_NE(nullptr, page);
+    EXPECT_EQ(i >= clean_reserve, page->IsDirty());
+    bpm->UnpinPage(page_ids[i], false);
+  }
+
+  // Scenario: new pages evict the clean frames, whose content is read back from disk afterwards.
+  for (size_t i = 0; i < clean_reserve; ++i) {
+    page_id_t page_id;
+    auto *page = bpm->NewPage(&page_id);
+    ASSERT_NE(nullptr, page);
+    bpm->UnpinPage(page_id, false);
+  }
+  for (size_t i = 0; i < clean_reserve; ++i) {
+    auto *page = bpm->FetchPage(page_ids[i]);
+    ASSERT_NE(nullptr, page);
+    EXPECT_EQ(0, strcmp(page->GetData(), ("page " + std::to_string(page_ids[i])).c_str()));
+    bpm->UnpinPage(page_ids[i], false);
+  }
+
+  // Shutdown the disk manager and remove the temporary file we created.
+  delete bpm;
+  disk_manager->ShutDown();
+  remove("test.db");
+
+  delete disk_manager;
+}
+
+// NOLINTNEXTLINE
+TEST(BufferPoolManagerTest, ReadAheadTest) {
+  const size_t buffer_pool_size = 16;
+  const size_t num_pages = 32;
+  const size_t k = 2;
+
+  auto disk_manager = std::make_unique<CountingDiskManager>();
+  auto bpm = std::make_unique<BufferPoolManager>(buffer_pool_size, disk_manager.get(), k);
+
+  std::vector<page_id_t> page_ids;
+  for (size_t i = 0; i < num_pages; ++i) {
+    page_id_t page_id;
+    auto *page = bpm->NewPage(&page_id);
+    ASSERT_NE(nullptr, page);
+    snprintf(page->GetData(), BUSTUB_PAGE_SIZE, "page %d", page_id);
+    bpm->UnpinPage(page_id, true);
+    page_ids.push_back(page_id);
+  }
+  // The first pages have been evicted to make room for the last ones.
+  ASSERT_EQ(0, disk_manager->num_reads_.load());
+
+  auto wait_for_reads = [&](int expected) {
+    for (int i = 0; i < 200 && disk_manager->num_reads_.load() < expected; ++i) {
+      std::this_thread::sleep_for(std::chrono::milliseconds(5));
+    }
+    std::this_thread::sleep_for(std::chrono::milliseconds(20));
+  };
+
+  // Scenario: a scan that misses reads the page and triggers read-ahead of the following pages.
+  auto *page = bpm->FetchPage(page_ids[0], AccessType::Scan);
+  ASSERT_NE(nullptr, page);
+  EXPECT_EQ(0, strcmp(page->GetData(), "page 0"));
+  bpm->UnpinPage(page_ids[0], false);
+  wait_for_reads(1 + READ_AHEAD_PAGES);
+  ASSERT_EQ(1 + READ_AHEAD_PAGES, disk_manager->num_reads_.load());
+
+  // Scenario: the prefetched pages are hits, and scanning them keeps the read-ahead window moving forward.
+  for (int i = 1; i <= READ_AHEAD_PAGES; ++i) {
+    auto reads = disk_manager->num_reads_.load();
+    page = bpm->FetchPage(page_ids[i], AccessType::Scan);
+    ASSERT_NE(nullptr, page);
+    EXPECT_EQ(0, strcmp(page->GetData(), ("page " + std::to_string(page_ids[i])).c_str()));
+    bpm->UnpinPage(page_ids[i], false);
+    wait_for_reads(reads + 1);
+    EXPECT_EQ(reads + 1, disk_manager->num_reads_.load());
+  }
+
+  // Scenario: a point lookup does not trigger read-ahead.
+  auto reads = disk_manager->num_reads_.load();
+  page = bpm->FetchPage(page_ids[0]);
+  ASSERT_NE(nullptr, page);
+  bpm->UnpinPage(page_ids[0], false);
+  std::this_thread::sleep_for(std::chrono::milliseconds(50));
+  EXPECT_GE(reads + 1, disk_manager->num_reads_.load());
+}
+
+// NOLINTNEXTLINE
+TEST(BufferPoolManagerTest, ScanRingTest) {
+  const size_t buffer_pool_size = 64;
+  const size_t num_hot_pages = 32;
+  const size_t num_cold_pages = 200;
+  const size_t k = 2;
+
+  auto disk_manager = std::make_unique<CountingDiskManager>();
+  auto bpm = std::make_unique<BufferPoolManager>(buffer_pool_size, disk_manager.get(), k);
+
+  std::vector<page_id_t> hot_page_ids;
+  std::vector<page_id_t> cold_page_ids;
+  for (size_t i = 0; i < num_hot_pages + num_cold_pages; ++i) {
+    page_id_t page_id;
+    auto *page = bpm->NewPage(&page_id);
+    ASSERT_NE(nullptr, page);
+    bpm->UnpinPage(page_id, true);
+    (i < num_hot_pages ? hot_page_ids : cold_page_ids).push_back(page_id);
+  }
+
+  // Scenario: the hot pages are the working set of point accesses, bring them into the pool.
+  for (int round = 0; round < 2; ++round) {
+    for (auto page_id : hot_page_ids) {
+      ASSERT_NE(nullptr, bpm->FetchPage(page_id));
+      bpm->UnpinPage(page_id, false);
+    }
+  }
+
+  // Scenario: a scan touches every cold page several times, like a table iterator does once per tuple.
+  for (auto page_id : cold_page_ids) {
+    for (int i = 0; i < 3; ++i) {
+      ASSERT_NE(nullptr, bpm->FetchPage(page_id, AccessType::Scan));
+      bpm->UnpinPage(page_id, false);
+    }
+  }
+
+  // Wait for the read-ahead to settle.
+  int reads = -1;
+  while (reads != disk_manager->num_reads_.load()) {
+    reads = disk_manager->num_reads_.load();
+    std::this_thread::sleep_for(std::chrono::milliseconds(50));
+  }
+
+  // Scenario: the scan only recycled the frames of its ring, every hot page is still in the pool.
+  for (auto page_id : hot_page_ids) {
+    ASSERT_NE(nullptr, bpm->FetchPage(page_id));
+    bpm->UnpinPage(page_id, false);
+  }
+  EXPECT_EQ(reads, disk_manager->num_reads_.load());
+}
+
+// NOLINTNEXTLINE
+TEST(BufferPoolManagerTest, ConcurrentHitTest) {
+  const size_t buffer_pool_size = 32;
+  const size_t num_pages = 48;
+  const size_t k = 2;
+
+  auto disk_manager = std::make_unique<DiskManagerUnlimitedMemory>();
+  auto bpm = std::make_unique<BufferPoolManager>(buffer_pool_size, disk_manager.get(), k, nullptr, 4);
+
+  std::vector<page_id_t> page_ids;
+  for (size_t i = 0; i < num_pages; ++i) {
+    page_id_t page_id;
+    auto *page = bpm->NewPage(&page_id);
+    ASSERT_NE(nullptr, page);
+    snprintf(page->GetData(), BUSTUB_PAGE_SIZE, "page %d", page_id);
+    bpm->UnpinPage(page_id, true);
+    page_ids.push_back(page_id);
+  }
+
+  // Scenario: lock-free hits race with misses that evict frames, every fetch must see the page it asked for.
+  std::vector<std::thread> threads;
+  for (int t = 0; t < 4; ++t) {
+    threads.emplace_back([&, t] {
+      std::mt19937 gen(t);
+      // most accesses go to a small hot set, so hits and evictions interleave
+      std::uniform_int_distribution<size_t> hot(0, buffer_pool_size / 2 - 1);
+      std::uniform_int_distribution<size_t> any(0, num_pages - 1);
+      char expected[32];
+      for (int i = 0; i < 5000; ++i) {
+        page_id_t page_id = page_ids[i % 4 == 0 ? any(gen) : hot(gen)];
+        auto *page = bpm->FetchPage(page_id);
+        ASSERT_NE(nullptr, page);
+        ASSERT_EQ(page_id, page->GetPageId());
+        snprintf(expected, sizeof(expected), "page %d", page_id);
+        ASSERT_EQ(0, strcmp(page->GetData(), expected));
+        ASSERT_TRUE(bpm->UnpinPage(page_id, i % 8 == 0));
+      }
+    });
+  }
+  for (auto &thread : threads) {
+    thread.join();
+  }
+
+  // Scenario: all the pins were released, every frame can be evicted again.
+  for (auto page_id : page_ids) {
+    auto *page = bpm->FetchPage(page_id);
+    ASSERT_NE(nullptr, page);
+    ASSERT_EQ(1, page->GetPinCount());
+    ASSERT_TRUE(bpm->UnpinPage(page_id, false));
+    ASSERT_FALSE(bpm->UnpinPage(page_id, false));
+  }
+}
+
+// NOLINTNEXTLINE
+TEST(BufferPoolManagerTest, ConcurrentEvictTest) {
+  const size_t buffer_pool_size = 8;
+  const size_t num_pages = 12;
+  const size_t k = 2;
+
+  for (auto policy : {ReplacerPolicy::LRU, ReplacerPolicy::Clock, ReplacerPolicy::LRUK, ReplacerPolicy::ARC,
+                      ReplacerPolicy::TwoQ}) {
+    SCOPED_TRACE(ReplacerPolicyToString(policy));
+    auto disk_manager = std::make_unique<DiskManagerUnlimitedMemory>();
+    auto bpm = std::make_unique<BufferPoolManager>(buffer_pool_size, disk_manager.get(), k, nullptr, 1, policy);
+
+    std::vector<page_id_t> page_ids;
+    for (size_t i = 0; i < num_pages; ++i) {
+      page_id_t page_id;
+      auto *page = bpm->NewPage(&page_id);
+      ASSERT_NE(nullptr, page);
+      snprintf(page->GetData(), BUSTUB_PAGE_SIZE, "page %d", page_id);
+      bpm->UnpinPage(page_id, true);
+      page_ids.push_back(page_id);
+    }
+
+    // Scenario: a little more pages than frames, so lock-free hits and evictions of the same frames interleave and
+    // unpins keep reaching the replacer while the frames they release are being evicted, put back into the replacer
+    // or sit on the free list.
+    std::vector<std::thread> threads;
+    for (int t = 0; t < 8; ++t) {
+      threads.emplace_back([&, t] {
+        std::mt19937 gen(t);
+        std::uniform_int_distribution<size_t> any(0, num_pages - 1);
+        char expected[32];
+        for (int i = 0; i < 10000; ++i) {
+          page_id_t page_id = page_ids[any(gen)];
+          auto *page = bpm->FetchPage(page_id);
+          if (page == nullptr) {
+            // every frame is pinned by the other threads
+            continue;
+          }
+          ASSERT_EQ(page_id, page->GetPageId());
+          snprintf(expected, sizeof(expected), "page %d", page_id);
+          ASSERT_EQ(0, strcmp(page->GetData(), expected));
+          ASSERT_TRUE(bpm->UnpinPage(page_id, i % 4 == 0));
+          if (i % 8 == 1) {
+            // a flush pins the frame while it writes, without the partition latch
+            bpm->FlushPage(page_id);
+          }
+          if (i % 16 == 0) {
+            // a page deleted and recreated returns its frame to the free list
+            page_id_t new_page_id;
+            if (auto *new_page = bpm->NewPage(&new_page_id); new_page != nullptr) {
+              bpm->UnpinPage(new_page_id, false);
+              bpm->DeletePage(new_page_id);
+            }
+          }
+        }
+      });
+    }
+    for (auto &thread : threads) {
+      thread.join();
+    }
+
+    // Scenario: no frame was lost by the replacer, all of them can be pinned at once.
+    std::vector<page_id_t> pinned;
+    for (size_t i = 0; i < buffer_pool_size; ++i) {
+      auto *page = bpm->FetchPage(page_ids[i]);
+      ASSERT_NE(nullptr, page);
+      pinned.push_back(page_ids[i]);
+    }
+    for (auto page_id : pinned) {
+      ASSERT_TRUE(bpm->UnpinPage(page_id, false));
+    }
+  }
+}
+
+// NOLINTNEXTLINE
+TEST(BufferPoolManagerTest, StatsTest) {
+  const size_t buffer_pool_size = 4;
+  const size_t k = 2;
+
+  auto disk_manager = std::make_unique<DiskManagerUnlimitedMemory>();
+  auto bpm = std::make_unique<BufferPoolManager>(buffer_pool_size, disk_manager.get(), k);
+
+  std::vector<page_id_t> page_ids;
+  for (size_t i = 0; i < buffer_pool_size + 2; ++i) {
+    page_id_t page_id;
+    ASSERT_NE(nullptr, bpm->NewPage(&page_id));
+    bpm->UnpinPage(page_id, i < 2);
+    page_ids.push_back(page_id);
+  }
+
+  // Scenario: creating two pages more than the pool holds evicted the first two pages, which were dirty.
+  auto stats = bpm->GetStats();
+  EXPECT_EQ(2, stats.evictions_);
+  EXPECT_EQ(2, stats.dirty_evictions_);
+  EXPECT_EQ(0, stats.free_frames_);
+
+  // Scenario: hits and misses are counted per access type, every miss lands in the latency histogram.
+  bpm->ResetStats();
+  ASSERT_NE(nullptr, bpm->FetchPage(page_ids.back(), AccessType::Get));
+  bpm->UnpinPage(page_ids.back(), false);
+  ASSERT_NE(nullptr, bpm->FetchPage(page_ids[0], AccessType::Get));
+  bpm->UnpinPage(page_ids[0], false);
+  ASSERT_NE(nullptr, bpm->FetchPage(page_ids.back()));
+  bpm->UnpinPage(page_ids.back(), false);
+
+  stats = bpm->GetStats();
+  EXPECT_EQ(1, stats.hits_[static_cast<size_t>(AccessType::Get)]);
+  EXPECT_EQ(1, stats.misses_[static_cast<size_t>(AccessType::Get)]);
+  EXPECT_EQ(1, stats.hits_[static_cast<size_t>(AccessType::Unknown)]);
+  EXPECT_EQ(0, stats.misses_[static_cast<size_t>(AccessType::Scan)]);
+  EXPECT_EQ(1, stats.evictions_);
+  EXPECT_DOUBLE_EQ(2.0 / 3, stats.HitRatio());
+  uint64_t misses = 0;
+  for (auto count : stats.miss_latency_us_) {
+    misses += count;
+  }
+  EXPECT_EQ(1, misses);
+  EXPECT_GT(stats.MissLatencyPercentile(50), 0);
+
+  // Scenario: deleting a page puts its frame back on the free list.
+  ASSERT_TRUE(bpm->DeletePage(page_ids[0]));
+  EXPECT_EQ(1, bpm->GetStats().free_frames_);
+}
+
+// NOLINTNEXTLINE
+TEST(BufferPoolManagerTest, ReplacerPolicyTest) {
+  const size_t buffer_pool_size = 8;
+  const size_t k = 2;
+  const size_t num_instances = 2;
+
+  for (auto policy : {ReplacerPolicy::LRU, ReplacerPolicy::Clock, ReplacerPolicy::LRUK, ReplacerPolicy::ARC,
+                      ReplacerPolicy::TwoQ}) {
+    SCOPED_TRACE(ReplacerPolicyToString(policy));
+    EXPECT_EQ(policy, ParseReplacerPolicy(ReplacerPolicyToString(policy)));
+    auto disk_manager = std::make_unique<DiskManagerUnlimitedMemory>();
+    auto bpm = std::make_unique<BufferPoolManager>(buffer_pool_size, disk_manager.get(), k, nullptr, num_instances,
+                                                   policy);
+
+    // Scenario: pinned pages are never evicted, whatever the policy.
+    page_id_t page_id;
+    for (size_t i = 0; i < buffer_pool_size; ++i) {
+      auto *page = bpm->NewPage(&page_id);
+      ASSERT_NE(nullptr, page);
+      snprintf(page->GetData(), BUSTUB_PAGE_SIZE, "page %d", page_id);
+    }
+    EXPECT_EQ(nullptr, bpm->NewPage(&page_id));
+
+    // Scenario: once unpinned, pages cycle through the pool and come back from disk intact.
+    for (page_id_t i = 0; i < static_cast<page_id_t>(buffer_pool_size); ++i) {
+      EXPECT_TRUE(bpm->UnpinPage(i, true));
+    }
+    for (size_t round = 0; round < 3; ++round) {
+      for (page_id_t i = 0; i < static_cast<page_id_t>(2 * buffer_pool_size); ++i) {
+        auto *page = i < static_cast<page_id_t>(buffer_pool_size) ? bpm->FetchPage(i) : bpm->NewPage(&page_id);
+        ASSERT_NE(nullptr, page);
+        if (i < static_cast<page_id_t>(buffer_pool_size)) {
+          EXPECT_EQ(0, strcmp(page->GetData(), ("page " + std::to_string(i)).c_str()));
+          EXPECT_TRUE(bpm->UnpinPage(i, false));
+        } else {
+          EXPECT_TRUE(bpm->UnpinPage(page_id, false));
+        }
+      }
+    }
+
+    // Scenario: every frame was handed back to the replacer, so all of them can be taken again.
+    for (size_t i = 0; i < buffer_pool_size; ++i) {
+      EXPECT_NE(nullptr, bpm->NewPage(&page_id));
+    }
+    EXPECT_EQ(nullptr, bpm->NewPage(&page_id));
+  }
+}
+
+// NOLINTNEXTLINE
+TEST(BufferPoolManagerTest, FlushAllPagesTest) {
+  const size_t buffer_pool_size = 16;
+  const size_t k = 2;
+  const size_t num_instances = 2;
+
+  auto disk_manager = std::make_unique<CountingDiskManager>();
+  auto bpm = std::make_unique<BufferPoolManager>(buffer_pool_size, disk_manager.get(), k, nullptr, num_instances);
+
+  page_id_t page_id;
+  for (size_t i = 0; i < buffer_pool_size; ++i) {
+    auto *page = bpm->NewPage(&page_id);
+    ASSERT_NE(nullptr, page);
+    snprintf(page->GetData(), BUSTUB_PAGE_SIZE, "page %d", page_id);
+  }
+  // new pages are dirty, write them once
+  bpm->FlushAllPages();
+  disk_manager->num_write_calls_ = 0;
+  disk_manager->num_pages_written_ = 0;
+
+  // Scenario: pages 0-4, 8-9 and 12 are dirty, the rest is clean. Page 12 is write latched by another thread.
+  for (page_id_t i = 0; i < static_cast<page_id_t>(buffer_pool_size); ++i) {
+    EXPECT_TRUE(bpm->UnpinPage(i, i < 5 || i == 8 || i == 9 || i == 12));
+  }
+  auto page12 = bpm->FetchPageWrite(12);
+
+  // Scenario: the write latch of page 12 does not stop the runs before it from being written.
+  std::thread flusher([&] { bpm->FlushAllPages(); });
+  while (disk_manager->num_write_calls_ < 2) {
+    std::this_thread::sleep_for(std::chrono::milliseconds(1));
+  }
+  snprintf(page12.GetDataMut(), BUSTUB_PAGE_SIZE, "page 12 modified");
+  page12.Drop();
+  flusher.join();
+
+  // Scenario: only dirty pages are written, one write per run of consecutive page ids.
+  EXPECT_EQ(3, disk_manager->num_write_calls_);
+  EXPECT_EQ(8, disk_manager->num_pages_written_);
+  char data[BUSTUB_PAGE_SIZE];
+  disk_manager->DiskManagerUnlimitedMemory::ReadPage(9, data);
+  EXPECT_STREQ("page 9", data);
+  disk_manager->DiskManagerUnlimitedMemory::ReadPage(12, data);
+  EXPECT_STREQ("page 12 modified", data);
+
+  // Scenario: once everything is on disk, flushing again writes nothing.
+  bpm->FlushAllPages();
+  int num_write_calls = disk_manager->num_write_calls_;
+  bpm->FlushAllPages();
+  EXPECT_EQ(num_write_calls, disk_manager->num_write_calls_);
+}
+
+// NOLINTNEXTLINE
+TEST(BufferPoolManagerTest, PageReuseTest) {
+  const size_t buffer_pool_size = 4;
+  const size_t k = 2;
+
+  auto disk_manager = std::make_unique<CountingDiskManager>();
+  auto bpm = std::make_unique<BufferPoolManager>(buffer_pool_size, disk_manager.get(), k);
+
+  page_id_t page_id;
+  for (page_id_t i = 0; i < 8; ++i) {
+    auto *page = bpm->NewPage(&page_id);
+    ASSERT_NE(nullptr, page);
+    EXPECT_EQ(i, page_id);
+    snprintf(page->GetData(), BUSTUB_PAGE_SIZE, "page %d", page_id);
+    EXPECT_TRUE(bpm->UnpinPage(page_id, true));
+  }
+
+  // Scenario: deleted pages, resident or not, give their ids back to the next new pages. The dirty resident page is
+  // dropped without being written back.
+  int num_write_calls = disk_manager->num_write_calls_;
+  EXPECT_TRUE(bpm->DeletePage(1));
+  EXPECT_TRUE(bpm->DeletePage(6));
+  EXPECT_EQ(num_write_calls, disk_manager->num_write_calls_);
+  EXPECT_FALSE(disk_manager->IsPageAllocated(1));
+  ASSERT_NE(nullptr, bpm->NewPage(&page_id));
+  EXPECT_EQ(1, page_id);
+  EXPECT_TRUE(bpm->UnpinPage(page_id, false));
+  ASSERT_NE(nullptr, bpm->NewPage(&page_id));
+  EXPECT_EQ(6, page_id);
+  EXPECT_TRUE(bpm->UnpinPage(page_id, false));
+  ASSERT_NE(nullptr, bpm->NewPage(&page_id));
+  EXPECT_EQ(8, page_id);
+
+  // Scenario: a page id allocated by a NewPage that failed is not lost.
+  for (size_t i = 1; i < buffer_pool_size; ++i) {
+    ASSERT_NE(nullptr, bpm->NewPage(&page_id));
+  }
+  EXPECT_EQ(nullptr, bpm->NewPage(&page_id));
+  EXPECT_EQ(12, disk_manager->GetNumPages());
+
+  // Scenario: a reused page evicted without being modified does not read back the bytes of the deleted page.
+  for (page_id_t i = 8; i < 12; ++i) {
+    EXPECT_TRUE(bpm->UnpinPage(i, false));
+  }
+  for (page_id_t i : {1, 6}) {
+    auto *page = bpm->FetchPage(i);
+    ASSERT_NE(nullptr, page);
+    EXPECT_EQ(std::string(BUSTUB_PAGE_SIZE, '\0'), std::string(page->GetData(), BUSTUB_PAGE_SIZE));
+    EXPECT_TRUE(bpm->UnpinPage(i, false));
+  }
+}
+
+// NOLINTNEXTLINE
+TEST(BufferPoolManagerTest, FetchPagesTest) {
+  const size_t buffer_pool_size = 8;
+  const size_t k = 2;
+  const size_t num_instances = 2;
+  const page_id_t num_pages = 16;
+
+  auto disk_manager = std::make_unique<CountingDiskManager>();
+  {
+    auto bpm = std::make_unique<BufferPoolManager>(buffer_pool_size, disk_manager.get(), k, nullptr, num_instances);
+    page_id_t page_id;
+    for (page_id_t i = 0; i < num_pages; ++i) {
+      Page *page = bpm->NewPage(&page_id);
+      ASSERT_NE(nullptr, page);
+      snprintf(page->GetData(), BUSTUB_PAGE_SIZE, "page %d", page_id);
+      EXPECT_TRUE(bpm->UnpinPage(page_id, true));
+    }
+    bpm->FlushAllPages();
+  }
+  auto bpm = std::make_unique<BufferPoolManager>(buffer_pool_size, disk_manager.get(), k, nullptr, num_instances);
+  disk_manager->num_reads_ = 0;
+
+  // Scenario: every miss is read once, duplicates get their own pin, the guards come back in request order.
+  std::vector<page_id_t> page_ids = {3, 1, 3, 2};
+  {
+    auto guards = bpm->FetchPages(page_ids);
+    ASSERT_EQ(page_ids.size(), guards.size());
+    EXPECT_EQ(3, disk_manager->num_reads_);
+    for (size_t i = 0; i < page_ids.size(); ++i) {
+      EXPECT_EQ(page_ids[i], guards[i].PageId());
+      EXPECT_EQ("page " + std::to_string(page_ids[i]), std::string(guards[i].GetData()));
+    }
+    Page *page = bpm->FetchPage(3);
+    EXPECT_EQ(3, page->GetPinCount());
+    EXPECT_TRUE(bpm->UnpinPage(3, false));
+  }
+
+  // Scenario: the guards unpinned the pages, hits are not read again.
+  page_ids = {1, 2, 4};
+  {
+    auto guards = bpm->FetchPages(page_ids);
+    ASSERT_EQ(page_ids.size(), guards.size());
+    EXPECT_EQ(4, disk_manager->num_reads_);
+    EXPECT_EQ("page 4", std::string(guards[2].GetData()));
+    Page *page = bpm->FetchPage(1);
+    EXPECT_EQ(2, page->GetPinCount());
+    EXPECT_TRUE(bpm->UnpinPage(1, false));
+  }
+
+  // Scenario: a batch that does not fit in the pool fails as a whole and leaves no page pinned.
+  page_ids.clear();
+  for (page_id_t i = 0; i < num_pages; ++i) {
+    page_ids.push_back(i);
+  }
+  EXPECT_TRUE(bpm->FetchPages(page_ids).empty());
+  page_ids.resize(buffer_pool_size);
+  EXPECT_EQ(buffer_pool_size, bpm->FetchPages(page_ids).size());
+
+  // Scenario: an invalid page id fails the batch.
+  EXPECT_TRUE(bpm->FetchPages({1, INVALID_PAGE_ID}).empty());
+}
+
+// NOLINTNEXTLINE
+TEST(BufferPoolManagerTest, ResizeTest) {
+  const size_t buffer_pool_size = 4;
+  const size_t max_pool_size = 16;
+  const size_t k = 2;
+  const size_t num_instances = 2;
+
+  auto disk_manager = std::make_unique<DiskManagerUnlimitedMemory>();
+  auto bpm = std::make_unique<BufferPoolManager>(buffer_pool_size, disk_manager.get(), k, nullptr, num_instances,
+                                                 ReplacerPolicy::LRUK, max_pool_size);
+  EXPECT_EQ(max_pool_size, bpm->GetMaxPoolSize());
+  EXPECT_FALSE(bpm->Resize(max_pool_size + 1));
+  EXPECT_FALSE(bpm->Resize(num_instances - 1));
+
+  // Scenario: the pool is full of pinned pages, growing it makes room for more.
+  std::vector<page_id_t> page_ids;
+  page_id_t page_id;
+  auto new_page = [&] {
+    auto *page = bpm->NewPage(&page_id);
+    if (page != nullptr) {
+      snprintf(page->GetData(), BUSTUB_PAGE_SIZE, "page %d", page_id);
+      page_ids.push_back(page_id);
+    }
+    return page;
+  };
+  for (size_t i = 0; i < buffer_pool_size; ++i) {
+    ASSERT_NE(nullptr, new_page());
+  }
+  EXPECT_EQ(nullptr, new_page());
+  ASSERT_TRUE(bpm->Resize(max_pool_size));
+  EXPECT_EQ(max_pool_size, bpm->GetPoolSize());
+  EXPECT_EQ(max_pool_size - buffer_pool_size, bpm->GetStats().free_frames_);
+  while (page_ids.size() < max_pool_size) {
+    ASSERT_NE(nullptr, new_page());
+  }
+  EXPECT_EQ(nullptr, new_page());
+
+  // Scenario: shrinking stops at the highest pinned frame.
+  for (size_t i = 0; i + 1 < page_ids.size(); ++i) {
+    EXPECT_TRUE(bpm->UnpinPage(page_ids[i], true));
+  }
+  EXPECT_FALSE(bpm->Resize(buffer_pool_size));
+  EXPECT_EQ(max_pool_size, bpm->GetPoolSize());
+
+  // Scenario: once unpinned, the pages of the retired frames are written back and can be fetched again.
+  EXPECT_TRUE(bpm->UnpinPage(page_ids.back(), true));
+  ASSERT_TRUE(bpm->Resize(buffer_pool_size));
+  EXPECT_EQ(buffer_pool_size, bpm->GetPoolSize());
+  EXPECT_EQ(0, bpm->GetStats().free_frames_);
+  for (page_id_t id : page_ids) {
+    auto guard = bpm->FetchPageRead(id);
+    ASSERT_NE(nullptr, guard.GetData());
+    EXPECT_STREQ(("page " + std::to_string(id)).c_str(), guard.GetData());
+  }
+  for (size_t i = 0; i < buffer_pool_size; ++i) {
+    ASSERT_NE(nullptr, bpm->FetchPage(page_ids[i]));
+  }
+  EXPECT_EQ(nullptr, bpm->FetchPage(page_ids.back()));
+  for (size_t i = 0; i < buffer_pool_size; ++i) {
+    EXPECT_TRUE(bpm->UnpinPage(page_ids[i], false));
+  }
+
+  // Scenario: the retired frames come back zeroed when the pool grows again, a new page placed in one of them does
+  // not hold the bytes of the page the frame held before.
+  ASSERT_TRUE(bpm->Resize(max_pool_size));
+  for (size_t i = buffer_pool_size; i < max_pool_size; ++i) {
+    auto *page = bpm->NewPage(&page_id);
+    ASSERT_NE(nullptr, page);
+    EXPECT_EQ(std::string(BUSTUB_PAGE_SIZE, '\0'), std::string(page->GetData(), BUSTUB_PAGE_SIZE));
+    EXPECT_TRUE(bpm->UnpinPage(page_id, false));
+  }
+}
+
+// NOLINTNEXTLINE
+TEST(BufferPoolManagerTest, ConcurrentResizeTest) {
+  const size_t buffer_pool_size = 8;
+  const size_t max_pool_size = 32;
+  const size_t k = 2;
+  const size_t num_instances = 2;
+  const int num_pages = 64;
+
+  auto disk_manager = std::make_unique<DiskManagerUnlimitedMemory>();
+  auto bpm = std::make_unique<BufferPoolManager>(buffer_pool_size, disk_manager.get(), k, nullptr, num_instances,
+                                                 ReplacerPolicy::LRUK, max_pool_size);
+  for (int i = 0; i < num_pages; ++i) {
+    page_id_t page_id;
+    auto *page = bpm->NewPage(&page_id);
+    ASSERT_NE(nullptr, page);
+    snprintf(page->GetData(), BUSTUB_PAGE_SIZE, "page %d", page_id);
+    bpm->UnpinPage(page_id, true);
+  }
+
+  // Scenario: readers keep fetching pages while the pool grows and shrinks under them.
+  std::atomic<bool> done{false};
+  std::vector<std::thread> readers;
+  for (int t = 0; t < 3; ++t) {
+    readers.emplace_back([&, t] {
+      std::mt19937 rng(t);
+      while (!done) {
+        page_id_t page_id = static_cast<page_id_t>(rng() % num_pages);
+        auto guard = bpm->FetchPageRead(page_id);
+        if (guard.GetData() != nullptr) {
+          EXPECT_STREQ(("page " + std::to_string(page_id)).c_str(), guard.GetData());
+        }
+      }
+    });
+  }
+  for (int i = 0; i < 50; ++i) {
+    size_t size = i % 2 == 0 ? max_pool_size : buffer_pool_size;
+    // readers may pin a frame that is about to be retired, try again
+    while (!bpm->Resize(size)) {
+      std::this_thread::yield();
+    }
+  }
+  done = true;
+  for (auto &reader : readers) {
+    reader.join();
+  }
+  EXPECT_EQ(buffer_pool_size, bpm->GetPoolSize());
+}
+
 }  // namespace bustub
@@ -0,0 +1,72 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// frame_arena_test.cpp
+//
+// Identification: test/buffer/frame_arena_test.cpp
+//
+// Copyright (c) 2015-2023, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#include "buffer/frame_arena.h"
+
+#include <cstdint>
+#include <cstring>
+#include <memory>
+
+#include "buffer/buffer_pool_manager.h"
+#include "gtest/gtest.h"
+#include "storage/disk/disk_manager_memory.h"
+
+namespace bustub {
+
+// NOLINTNEXTLINE
+TEST(FrameArenaTest, LayoutTest) {
+  const size_t num_frames = 100;
+  for (bool use_huge_pages : {false, true}) {
+    FrameArena arena(num_frames, use_huge_pages);
+
+    // Scenario: frames are zeroed, page aligned and do not overlap.
+    for (size_t i = 0; i < num_frames; ++i) {
+      char *frame = arena.GetFrame(i);
+      ASSERT_EQ(0, reinterpret_cast<uintptr_t>(frame) % BUSTUB_PAGE_SIZE);
+      for (size_t j = 0; j < BUSTUB_PAGE_SIZE; ++j) {
+        ASSERT_EQ(0, frame[j]);
+      }
+      if (i > 0) {
+        ASSERT_GE(frame - arena.GetFrame(i - 1), BUSTUB_PAGE_SIZE);
+      }
+      std::memset(frame, static_cast<int>(i), BUSTUB_PAGE_SIZE);
+    }
+    for (size_t i = 0; i < num_frames; ++i) {
+      ASSERT_EQ(static_cast<char>(i), arena.GetFrame(i)[BUSTUB_PAGE_SIZE - 1]);
+    }
+
+    // Scenario: a released frame reads as zeroes, whether its memory went back to the system or not, and its
+    // neighbours are untouched.
+    arena.Release(7);
+    for (size_t j = 0; j < BUSTUB_PAGE_SIZE; ++j) {
+      ASSERT_EQ(0, arena.GetFrame(7)[j]);
+    }
+    ASSERT_EQ(static_cast<char>(6), arena.GetFrame(6)[BUSTUB_PAGE_SIZE - 1]);
+    ASSERT_EQ(static_cast<char>(8), arena.GetFrame(8)[0]);
+  }
+}
+
+// NOLINTNEXTLINE
+TEST(FrameArenaTest, BufferPoolTest) {
+  const size_t buffer_pool_size = 10;
+  auto disk_manager = std::make_unique<DiskManagerUnlimitedMemory>();
+  auto bpm = std::make_unique<BufferPoolManager>(buffer_pool_size, disk_manager.get());
+
+  // Scenario: the frames of the pool are page aligned and the metadata of every frame starts on its own cache line.
+  Page *pages = bpm->GetPages();
+  for (size_t i = 0; i < buffer_pool_size; ++i) {
+    ASSERT_EQ(0, reinterpret_cast<uintptr_t>(pages[i].GetData()) % BUSTUB_PAGE_SIZE);
+    ASSERT_EQ(0, reinterpret_cast<uintptr_t>(&pages[i]) % CACHE_LINE_SIZE);
+  }
+}
+
+}  // namespace bustub
@@ -95,4 +95,95 @@ TEST(LRUKReplacerTest, SampleTest) {
   ASSERT_EQ(false, lru_replacer.Evict(&value));
   ASSERT_EQ(0, lru_replacer.Size());
 }
+
+TEST(LRUKReplacerTest, LargeTest) {
+  const size_t num_frames = 100000;
+  LRUKReplacer lru_replacer(num_frames, 2);
+
+  // Scenario: access every frame once, then access the even frames again.
+  for (size_t i = 0; i < num_frames; ++i) {
+    lru_replacer.RecordAccess(static_cast<frame_id_t>(i));
+    lru_replacer.SetEvictable(static_cast<frame_id_t>(i), true);
+  }
+  for (size_t i = 0; i < num_frames; i += 2) {
+    lru_replacer.RecordAccess(static_cast<frame_id_t>(i));
+  }
+  ASSERT_EQ(num_frames, lru_replacer.Size());
+
+  // Scenario: pin and remove a few frames, they should never be chosen as victims.
+  lru_replacer.SetEvictable(1, false);
+  lru_replacer.SetEvictable(2, false);
+  lru_replacer.Remove(3);
+  lru_replacer.Remove(4);
+  ASSERT_EQ(num_frames - 4, lru_replacer.Size());
+
+  // Scenario: odd frames have +inf backward k-distance and go first in LRU order, then the even frames.
+  int value;
+  for (size_t i = 5; i < num_frames; i += 2) {
+    ASSERT_EQ(true, lru_replacer.Evict(&value));
+    ASSERT_EQ(static_cast<frame_id_t>(i), value);
+  }
+  ASSERT_EQ(true, lru_replacer.Evict(&value));
+  ASSERT_EQ(0, value);
+  for (size_t i = 6; i < num_frames; i += 2) {
+    ASSERT_EQ(true, lru_replacer.Evict(&value));
+    ASSERT_EQ(static_cast<frame_id_t>(i), value);
+  }
+  ASSERT_EQ(false, lru_replacer.Evict(&value));
+  ASSERT_EQ(0, lru_replacer.Size());
+
+  // Scenario: the pinned frames are still tracked and become victims once evictable again.
+  lru_replacer.SetEvictable(2, true);
+  lru_replacer.SetEvictable(1, true);
+  ASSERT_EQ(true, lru_replacer.Evict(&value));
+  ASSERT_EQ(1, value);
+  ASSERT_EQ(true, lru_replacer.Evict(&value));
+  ASSERT_EQ(2, value);
+}
+TEST(LRUKReplacerTest, EvictionCandidatesTest) {
+  LRUKReplacer lru_replacer(7, 2);
+
+  // Scenario: frames [1,2,3,4] are evictable, frame 1 has two accesses and frame 5 is non-evictable.
+  for (frame_id_t fid = 1; fid <= 5; ++fid) {
+    lru_replacer.RecordAccess(fid);
+    lru_replacer.SetEvictable(fid, fid != 5);
+  }
+  lru_replacer.RecordAccess(1);
+
+  // Scenario: peeking returns the eviction order and does not evict anything.
+  ASSERT_EQ((std::vector<frame_id_t>{2, 3}), lru_replacer.EvictionCandidates(2));
+  ASSERT_EQ((std::vector<frame_id_t>{2, 3, 4, 1}), lru_replacer.EvictionCandidates(10));
+  ASSERT_EQ(4, lru_replacer.Size());
+
+  int value;
+  for (frame_id_t expected : lru_replacer.EvictionCandidates(10)) {
+    ASSERT_EQ(true, lru_replacer.Evict(&value));
+    ASSERT_EQ(expected, value);
+  }
+  ASSERT_TRUE(lru_replacer.EvictionCandidates(10).empty());
+}
+
+TEST(LRUKReplacerTest, UntrackedFrameTest) {
+  LRUKReplacer lru_replacer(4, 2);
+
+  // Scenario: an unpin can reach the replacer after the frame was evicted, toggling an untracked frame does nothing.
+  lru_replacer.SetEvictable(0, true);
+  ASSERT_EQ(0, lru_replacer.Size());
+  lru_replacer.RecordAccess(0);
+  lru_replacer.SetEvictable(0, true);
+  frame_id_t frame_id;
+  ASSERT_TRUE(lru_replacer.Evict(&frame_id));
+  ASSERT_EQ(0, frame_id);
+  lru_replacer.SetEvictable(0, true);
+  lru_replacer.SetEvictable(0, false);
+  ASSERT_EQ(0, lru_replacer.Size());
+  ASSERT_FALSE(lru_replacer.Evict(&frame_id));
+
+  // the frame is tracked again, and not evictable, once it is accessed
+  lru_replacer.RecordAccess(0);
+  ASSERT_EQ(0, lru_replacer.Size());
+  lru_replacer.SetEvictable(0, true);
+  ASSERT_EQ(1, lru_replacer.Size());
+}
+
 }  // namespace bustub
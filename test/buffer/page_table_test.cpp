@@ -0,0 +1,105 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// page_table_test.cpp
+//
+// Identification: test/buffer/page_table_test.cpp
+//
+// Copyright (c) 2015-2023, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#include "buffer/page_table.h"
+
+#include <atomic>
+#include <thread>  // NOLINT
+#include <vector>
+
+#include "gtest/gtest.h"
+
+namespace bustub {
+
+// NOLINTNEXTLINE
+TEST(PageTableTest, SampleTest) {
+  const size_t max_entries = 64;
+  PageTable page_table(max_entries);
+
+  // Scenario: page ids of one partition are equal modulo the number of partitions, they must all be found.
+  for (page_id_t page_id = 0; page_id < static_cast<page_id_t>(max_entries); ++page_id) {
+    page_table.Insert(page_id * 16, page_id);
+  }
+  ASSERT_EQ(max_entries, page_table.Size());
+  for (page_id_t page_id = 0; page_id < static_cast<page_id_t>(max_entries); ++page_id) {
+    ASSERT_EQ(page_id, page_table.Find(page_id * 16));
+  }
+  ASSERT_EQ(-1, page_table.Find(1));
+
+  // Scenario: inserting an existing page replaces its frame.
+  page_table.Insert(16, 100);
+  ASSERT_EQ(100, page_table.Find(16));
+  ASSERT_EQ(max_entries, page_table.Size());
+
+  // Scenario: erasing every other page keeps the others reachable.
+  for (page_id_t page_id = 0; page_id < static_cast<page_id_t>(max_entries); page_id += 2) {
+    ASSERT_TRUE(page_table.Erase(page_id * 16));
+  }
+  ASSERT_FALSE(page_table.Erase(0));
+  ASSERT_EQ(max_entries / 2, page_table.Size());
+  for (page_id_t page_id = 0; page_id < static_cast<page_id_t>(max_entries); ++page_id) {
+    frame_id_t expected = page_id % 2 == 0 ? -1 : (page_id == 1 ? 100 : page_id);
+    ASSERT_EQ(expected, page_table.Find(page_id * 16));
+  }
+
+  size_t count = 0;
+  page_table.ForEach([&](page_id_t page_id, frame_id_t frame_id) {
+    ASSERT_EQ(1, page_id / 16 % 2);
+    ASSERT_EQ(page_id == 16 ? 100 : page_id / 16, frame_id);
+    count++;
+  });
+  ASSERT_EQ(max_entries / 2, count);
+}
+
+// NOLINTNEXTLINE
+TEST(PageTableTest, ConcurrentFindTest) {
+  const size_t max_entries = 256;
+  const page_id_t num_stable_pages = 64;
+  PageTable page_table(max_entries);
+  for (page_id_t page_id = 0; page_id < num_stable_pages; ++page_id) {
+    page_table.Insert(page_id, page_id + 1000);
+  }
+
+  std::atomic<bool> done{false};
+  std::vector<std::thread> readers;
+  for (int i = 0; i < 4; ++i) {
+    readers.emplace_back([&] {
+      while (!done) {
+        // Scenario: a lock-free lookup may miss a page that is being moved, but never returns a wrong frame.
+        for (page_id_t page_id = 0; page_id < num_stable_pages; ++page_id) {
+          frame_id_t frame_id = page_table.Find(page_id);
+          ASSERT_TRUE(frame_id == -1 || frame_id == page_id + 1000);
+        }
+      }
+    });
+  }
+
+  // The writer keeps inserting and erasing other pages, shifting the clusters of the stable pages.
+  for (int round = 0; round < 200; ++round) {
+    for (page_id_t page_id = num_stable_pages; page_id < static_cast<page_id_t>(max_entries); ++page_id) {
+      page_table.Insert(page_id, page_id);
+    }
+    for (page_id_t page_id = num_stable_pages; page_id < static_cast<page_id_t>(max_entries); ++page_id) {
+      page_table.Erase(page_id);
+    }
+  }
+  done = true;
+  for (auto &reader : readers) {
+    reader.join();
+  }
+
+  for (page_id_t page_id = 0; page_id < num_stable_pages; ++page_id) {
+    ASSERT_EQ(page_id + 1000, page_table.Find(page_id));
+  }
+}
+
+}  // namespace bustub
@@ -0,0 +1,61 @@
+/**
+ * two_queue_replacer_test.cpp
+ */
+
+#include "buffer/two_queue_replacer.h"
+
+#include <vector>
+
+#include "gtest/gtest.h"
+
+namespace bustub {
+
+TEST(TwoQueueReplacerTest, SampleTest) {
+  // Kin = 2 frames, Kout = 4 pages
+  TwoQueueReplacer two_queue_replacer(8);
+
+  // Scenario: frames 0-3 hold pages 100-103, seen for the first time, so all of them are in A1in.
+  for (frame_id_t frame_id = 0; frame_id < 4; frame_id++) {
+    two_queue_replacer.RecordAccess(frame_id, AccessType::Unknown, 100 + frame_id);
+    two_queue_replacer.SetEvictable(frame_id, true);
+  }
+  ASSERT_EQ(4, two_queue_replacer.Size());
+
+  // Scenario: A1in is a FIFO, accessing frame 0 again does not save it.
+  two_queue_replacer.RecordAccess(0, AccessType::Unknown, 100);
+  int value;
+  ASSERT_TRUE(two_queue_replacer.Evict(&value));
+  EXPECT_EQ(0, value);
+
+  // Scenario: page 100 comes back while it is remembered in A1out, so it goes to Am.
+  two_queue_replacer.RecordAccess(0, AccessType::Unknown, 100);
+  two_queue_replacer.SetEvictable(0, true);
+  EXPECT_EQ((std::vector<frame_id_t>{1, 2, 3, 0}), two_queue_replacer.EvictionCandidates(4));
+
+  // Scenario: A1in shrinks to Kin first, then Am loses its least recently used frame.
+  ASSERT_TRUE(two_queue_replacer.Evict(&value));
+  EXPECT_EQ(1, value);
+  ASSERT_TRUE(two_queue_replacer.Evict(&value));
+  EXPECT_EQ(0, value);
+
+  // Scenario: A1in is used when Am has nothing evictable, pinned frames are skipped.
+  two_queue_replacer.SetEvictable(2, false);
+  EXPECT_EQ(1, two_queue_replacer.Size());
+  ASSERT_TRUE(two_queue_replacer.Evict(&value));
+  EXPECT_EQ(3, value);
+  EXPECT_FALSE(two_queue_replacer.Evict(&value));
+
+  // Scenario: page 100 left Am for good, it is not remembered any more and enters A1in again.
+  two_queue_replacer.RecordAccess(0, AccessType::Unknown, 100);
+  two_queue_replacer.SetEvictable(0, true);
+  two_queue_replacer.SetEvictable(2, true);
+  EXPECT_EQ((std::vector<frame_id_t>{2, 0}), two_queue_replacer.EvictionCandidates(4));
+
+  // Scenario: removing a frame does not remember its page.
+  two_queue_replacer.Remove(2);
+  two_queue_replacer.RecordAccess(2, AccessType::Unknown, 102);
+  two_queue_replacer.SetEvictable(2, true);
+  EXPECT_EQ((std::vector<frame_id_t>{0, 2}), two_queue_replacer.EvictionCandidates(4));
+}
+
+}  // namespace bustub
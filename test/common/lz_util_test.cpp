@@ -0,0 +1,78 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// lz_util_test.cpp
+//
+// Identification: test/common/lz_util_test.cpp
+//
+// Copyright (c) 2015-2023, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#include <random>
+#include <string>
+#include <vector>
+
+#include "common/util/lz_util.h"
+#include "gtest/gtest.h"
+
+namespace bustub {
+
+namespace {
+/** Compress and decompress the data. @return the compressed size */
+auto RoundTrip(const std::string &data) -> size_t {
+  std::vector<char> compressed(data.size() + data.size() / 255 + 16);
+  size_t size = LzUtil::Compress(data.data(), data.size(), compressed.data(), compressed.size());
+  EXPECT_GT(size, 0);
+  std::string decompressed(data.size(), '\0');
+  EXPECT_EQ(data.size(), LzUtil::Decompress(compressed.data(), size, decompressed.data(), decompressed.size()));
+  EXPECT_EQ(data, decompressed);
+  return size;
+}
+}  // namespace
+
+// NOLINTNEXTLINE
+TEST(LzUtilTest, RoundTripTest) {
+  EXPECT_EQ(1, RoundTrip(""));
+  RoundTrip("abc");
+
+  // long runs and overlapping matches
+  EXPECT_LT(RoundTrip(std::string(4096, '\0')), 32);
+  EXPECT_LT(RoundTrip(std::string(4096, 'a') + std::string(4096, 'b')), 64);
+
+  // text-like data compresses well
+  std::string text;
+  for (int i = 0; text.size() < 4096; i++) {
+    text += "key=" + std::to_string(i) + ", value=row number " + std::to_string(i * 7) + "; ";
+  }
+  EXPECT_LT(RoundTrip(text), text.size() / 2);
+
+  // random data does not compress, every length extension is exercised
+  std::mt19937 rng(15445);
+  std::string random(70000, '\0');
+  for (auto &c : random) {
+    c = static_cast<char>(rng());
+  }
+  RoundTrip(random);
+  std::vector<char> small(4095);
+  EXPECT_EQ(0, LzUtil::Compress(random.data(), 4096, small.data(), small.size()));
+}
+
+// NOLINTNEXTLINE
+TEST(LzUtilTest, CorruptedTest) {
+  std::string data(4096, 'x');
+  std::vector<char> compressed(64);
+  size_t size = LzUtil::Compress(data.data(), data.size(), compressed.data(), compressed.size());
+  ASSERT_GT(size, 0);
+  std::string out(data.size(), '\0');
+
+  // truncated input, too small an output, and a match reaching before the start of the output
+  EXPECT_EQ(0, LzUtil::Decompress(compressed.data(), size - 2, out.data(), out.size()));
+  EXPECT_EQ(0, LzUtil::Decompress(compressed.data(), size, out.data(), out.size() - 1));
+  compressed[2] = 0x7f;
+  compressed[3] = 0x7f;
+  EXPECT_EQ(0, LzUtil::Decompress(compressed.data(), size, out.data(), out.size()));
+}
+
+}  // namespace bustub
@@ -26,6 +26,13 @@ class Counter {
     count_ += num;
     mutex_.WUnlock();
   }
+  void AddWithUpgrade(int num) {
+    mutex_.ULock();
+    int res = count_;
+    mutex_.Upgrade();
+    count_ = res + num;
+    mutex_.WUnlock();
+  }
   auto Read() -> int {
     int res;
     mutex_.RLock();
@@ -57,4 +64,24 @@ TEST(RWLatchTest, BasicTest) {
   }
   EXPECT_EQ(counter.Read(), 55);
 }
+
+// NOLINTNEXTLINE
+TEST(RWLatchTest, UpgradeTest) {
+  int num_threads = 100;
+  Counter counter{};
+  std::vector<std::thread> threads;
+  for (int tid = 0; tid < num_threads; tid++) {
+    if (tid % 3 == 0) {
+      threads.emplace_back([&counter]() { counter.Read(); });
+    } else if (tid % 3 == 1) {
+      threads.emplace_back([&counter]() { counter.Add(1); });
+    } else {
+      threads.emplace_back([&counter]() { counter.AddWithUpgrade(1); });
+    }
+  }
+  for (int i = 0; i < num_threads; i++) {
+    threads[i].join();
+  }
+  EXPECT_EQ(counter.Read(), 66);
+}
 }  // namespace bustub
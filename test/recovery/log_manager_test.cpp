@@ -0,0 +1,106 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// log_manager_test.cpp
+//
+// Identification: test/recovery/log_manager_test.cpp
+//
+// Copyright (c) 2015-2023, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#include <cstdio>
+#include <thread>  // NOLINT
+#include <vector>
+
+#include "gtest/gtest.h"
+#include "recovery/log_manager.h"
+#include "storage/disk/disk_manager.h"
+
+namespace bustub {
+
+class LogManagerTest : public ::testing::Test {
+ protected:
+  void SetUp() override {
+    remove("test.db");
+    remove("test.log");
+    remove("test.fsm");
+  }
+
+  void TearDown() override {
+    remove("test.db");
+    remove("test.log");
+    remove("test.fsm");
+  }
+};
+
+/** The size of a commit record: its header of size, lsn, txn id, prev lsn and type. */
+static constexpr int COMMIT_RECORD_SIZE = 20;
+
+/** Check that the log file holds the commit records with LSNs 0, 1, ... num_records - 1. */
+static void CheckLog(DiskManager *disk_manager, int num_records) {
+  std::vector<char> log(num_records * COMMIT_RECORD_SIZE);
+  ASSERT_TRUE(disk_manager->ReadLog(log.data(), log.size(), 0));
+  for (int i = 0; i < num_records; i++) {
+    const char *header = log.data() + i * COMMIT_RECORD_SIZE;
+    EXPECT_EQ(COMMIT_RECORD_SIZE, *reinterpret_cast<const int32_t *>(header));
+    EXPECT_EQ(i, *reinterpret_cast<const lsn_t *>(header + sizeof(int32_t)));
+  }
+  EXPECT_FALSE(disk_manager->ReadLog(log.data(), 1, log.size()));
+}
+
+// NOLINTNEXTLINE
+TEST_F(LogManagerTest, GroupCommitTest) {
+  const int num_threads = 8;
+  const int commits_per_thread = 50;
+  DiskManager disk_manager("test.db");
+  LogManager log_manager(&disk_manager);
+  log_manager.RunFlushThread();
+  EXPECT_TRUE(enable_logging);
+
+  // Scenario: every commit waits until its record is durable, the flush thread syncs the commits in batches.
+  std::vector<std::thread> threads;
+  for (int tid = 0; tid < num_threads; tid++) {
+    threads.emplace_back([&log_manager, tid]() {
+      for (int i = 0; i < commits_per_thread; i++) {
+        LogRecord record(tid, INVALID_LSN, LogRecordType::COMMIT);
+        lsn_t lsn = log_manager.AppendLogRecord(&record);
+        log_manager.WaitForDurable(lsn);
+        EXPECT_GE(log_manager.GetPersistentLSN(), lsn);
+      }
+    });
+  }
+  for (auto &thread : threads) {
+    thread.join();
+  }
+  log_manager.StopFlushThread();
+  EXPECT_FALSE(enable_logging);
+
+  int num_records = num_threads * commits_per_thread;
+  EXPECT_EQ(num_records - 1, log_manager.GetPersistentLSN());
+  EXPECT_LE(disk_manager.GetNumFlushes(), num_records);
+  CheckLog(&disk_manager, num_records);
+  disk_manager.ShutDown();
+}
+
+// NOLINTNEXTLINE
+TEST_F(LogManagerTest, FlushWithoutThreadTest) {
+  DiskManager disk_manager("test.db");
+  LogManager log_manager(&disk_manager);
+
+  // Scenario: without a flush thread, the waiter writes the log buffer itself.
+  lsn_t lsn = INVALID_LSN;
+  for (int i = 0; i < 3; i++) {
+    LogRecord record(0, lsn, LogRecordType::COMMIT);
+    lsn = log_manager.AppendLogRecord(&record);
+  }
+  EXPECT_EQ(INVALID_LSN, log_manager.GetPersistentLSN());
+  log_manager.WaitForDurable(lsn);
+  EXPECT_EQ(2, log_manager.GetPersistentLSN());
+  EXPECT_EQ(1, disk_manager.GetNumFlushes());
+  CheckLog(&disk_manager, 3);
+  disk_manager.ShutDown();
+}
+
+}  // namespace bustub
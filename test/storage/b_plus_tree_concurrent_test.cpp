@@ -10,6 +10,7 @@
 //
 //===----------------------------------------------------------------------===//
 
+#include <atomic>
 #include <chrono>  // NOLINT
 #include <cstdio>
 #include <functional>
@@ -402,4 +403,122 @@ TEST(BPlusTreeConcurrentTest, MixTest2) {
   delete bpm;
 }
 
+TEST(BPlusTreeConcurrentTest, OptimisticLookupTest) {
+  // create KeyComparator and index schema
+  auto key_schema = ParseCreateStatement("a bigint");
+  GenericComparator<8> comparator(key_schema.get());
+
+  auto disk_manager = std::make_unique<DiskManagerUnlimitedMemory>();
+  auto *bpm = new BufferPoolManager(50, disk_manager.get());
+
+  // create and fetch header_page
+  page_id_t page_id;
+  auto *header_page = bpm->NewPage(&page_id);
+  (void)header_page;
+
+  // small nodes, so that the writers keep splitting and merging the pages the readers descend through
+  BPlusTree<GenericKey<8>, RID, GenericComparator<8>> tree("foo_pk", page_id, bpm, comparator, 3, 3);
+
+  std::vector<int64_t> perserved_keys;
+  std::vector<int64_t> dynamic_keys;
+  for (int64_t i = 1; i <= 300; i++) {
+    (i % 3 == 0 ? perserved_keys : dynamic_keys).push_back(i);
+  }
+  InsertHelper(&tree, perserved_keys, 1);
+
+  std::atomic<int> num_readers{3};
+  std::vector<std::thread> readers;
+  for (int i = 0; i < 3; i++) {
+    readers.emplace_back([&] {
+      GenericKey<8> index_key;
+      std::vector<RID> rids;
+      for (int pass = 0; pass < 50; pass++) {
+        for (auto key : perserved_keys) {
+          rids.clear();
+          index_key.SetFromInteger(key);
+          ASSERT_TRUE(tree.GetValue(index_key, &rids));
+          ASSERT_EQ(1, rids.size());
+          ASSERT_EQ(key & 0xFFFFFFFF, rids[0].GetSlotNum());
+        }
+      }
+      num_readers--;
+    });
+  }
+
+  // Scenario: lookups of the keys that are never removed always succeed while the tree changes shape.
+  while (num_readers > 0) {
+    InsertHelper(&tree, dynamic_keys, 1);
+    DeleteHelper(&tree, dynamic_keys, 1);
+  }
+  for (auto &reader : readers) {
+    reader.join();
+  }
+
+  bpm->UnpinPage(HEADER_PAGE_ID, true);
+  delete bpm;
+}
+
+TEST(BPlusTreeConcurrentTest, OptimisticWriteTest) {
+  // create KeyComparator and index schema
+  auto key_schema = ParseCreateStatement("a bigint");
+  GenericComparator<8> comparator(key_schema.get());
+
+  auto disk_manager = std::make_unique<DiskManagerUnlimitedMemory>();
+  auto *bpm = new BufferPoolManager(50, disk_manager.get());
+
+  // create and fetch header_page
+  page_id_t page_id;
+  auto *header_page = bpm->NewPage(&page_id);
+  (void)header_page;
+
+  // leaves large enough that most writes change only their leaf, with a split or a merge now and then
+  BPlusTree<GenericKey<8>, RID, GenericComparator<8>> tree("foo_pk", page_id, bpm, comparator, 8, 5);
+
+  std::vector<int64_t> keys;
+  for (int64_t i = 1; i <= 1000; i++) {
+    keys.push_back(i);
+  }
+
+  // Scenario: writers insert and remove keys of their own, interleaved in the same leaves, and finally keep every
+  // third key.
+  const int num_writers = 4;
+  std::vector<std::thread> threads;
+  for (int i = 0; i < num_writers; i++) {
+    threads.emplace_back([&, i] {
+      for (int pass = 0; pass < 3; pass++) {
+        InsertHelperSplit(&tree, keys, num_writers, i);
+        DeleteHelperSplit(&tree, keys, num_writers, i);
+      }
+      InsertHelperSplit(&tree, keys, num_writers, i);
+      for (auto key : keys) {
+        if (key % num_writers == i && key % 3 != 0) {
+          GenericKey<8> index_key;
+          index_key.SetFromInteger(key);
+          tree.Remove(index_key, nullptr);
+        }
+      }
+    });
+  }
+  for (auto &thread : threads) {
+    thread.join();
+  }
+
+  int64_t size = 0;
+  for (auto iter = tree.Begin(); iter != tree.End(); ++iter) {
+    size++;
+    ASSERT_EQ(0, (*iter).first.ToString() % 3);
+  }
+  ASSERT_EQ(1000 / 3, size);
+  std::vector<RID> rids;
+  for (auto key : keys) {
+    rids.clear();
+    GenericKey<8> index_key;
+    index_key.SetFromInteger(key);
+    ASSERT_EQ(key % 3 == 0, tree.GetValue(index_key, &rids));
+  }
+
+  bpm->UnpinPage(HEADER_PAGE_ID, true);
+  delete bpm;
+}
+
 }  // namespace bustub
@@ -12,6 +12,7 @@
 
 #include <algorithm>
 #include <cstdio>
+#include <random>
 
 #include "buffer/buffer_pool_manager.h"
 #include "gtest/gtest.h"
@@ -197,6 +198,61 @@ TEST(BPlusTreeTests, InsertTest3) {
     current_key = current_key + 1;
   }
 
+  bpm->UnpinPage(HEADER_PAGE_ID, true);
+  delete transaction;
+  delete bpm;
+}
+
+TEST(BPlusTreeTests, LargePageInsertTest) {
+  // create KeyComparator and index schema
+  auto key_schema = ParseCreateStatement("a bigint");
+  GenericComparator<8> comparator(key_schema.get());
+  using LeafPage = BPlusTreeLeafPage<GenericKey<8>, RID, GenericComparator<8>>;
+
+  auto disk_manager = std::make_unique<DiskManagerUnlimitedMemory>(BUSTUB_MAX_PAGE_SIZE);
+  auto *bpm = new BufferPoolManager(50, disk_manager.get());
+  ASSERT_EQ(BUSTUB_MAX_PAGE_SIZE, bpm->GetPageSize());
+  page_id_t page_id;
+  auto header_page = bpm->NewPage(&page_id);
+
+  // the default max sizes fill the pages of the buffer pool
+  BPlusTree<GenericKey<8>, RID, GenericComparator<8>> tree("foo_pk", header_page->GetPageId(), bpm, comparator);
+  GenericKey<8> index_key;
+  RID rid;
+  auto *transaction = new Transaction(0);
+
+  std::vector<int64_t> keys;
+  for (int64_t key = 1; key <= 10000; key++) {
+    keys.push_back(key);
+  }
+  std::shuffle(keys.begin(), keys.end(), std::mt19937(15445));
+  for (auto key : keys) {
+    rid.Set(static_cast<int32_t>(key >> 32), key & 0xFFFFFFFF);
+    index_key.SetFromInteger(key);
+    ASSERT_TRUE(tree.Insert(index_key, rid, transaction));
+  }
+
+  // every leaf holds thousands of keys, so the root has only a few children
+  auto root_guard = bpm->FetchPageRead(tree.GetRootPageId());
+  ASSERT_FALSE(root_guard.As<BPlusTreePage>()->IsLeafPage());
+  EXPECT_LE(root_guard.As<BPlusTreePage>()->GetSize(), 2 * 10000 / LeafPage::Capacity(BUSTUB_MAX_PAGE_SIZE) + 1);
+  root_guard.Drop();
+
+  std::vector<RID> rids;
+  for (auto key : keys) {
+    rids.clear();
+    index_key.SetFromInteger(key);
+    ASSERT_TRUE(tree.GetValue(index_key, &rids));
+    EXPECT_EQ(rids[0].GetSlotNum(), key);
+  }
+  int64_t current_key = 1;
+  for (auto iterator = tree.Begin(); iterator != tree.End(); ++iterator) {
+    EXPECT_EQ((*iterator).second.GetSlotNum(), current_key);
+    current_key++;
+  }
+  EXPECT_EQ(current_key, 10001);
+
+
   bpm->UnpinPage(HEADER_PAGE_ID, true);
   delete transaction;
   delete bpm;
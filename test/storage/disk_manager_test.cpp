@@ -10,11 +10,21 @@
 //
 //===----------------------------------------------------------------------===//
 
+#include <chrono>  // NOLINT
 #include <cstring>
+#include <fstream>
+#include <iterator>
+#include <memory>
+#include <string>
+#include <thread>  // NOLINT
+#include <vector>
 
 #include "common/exception.h"
 #include "gtest/gtest.h"
 #include "storage/disk/disk_manager.h"
+#include "storage/disk/disk_manager_compressed.h"
+#include "storage/disk/disk_manager_memory.h"
+#include "storage/disk/disk_manager_uring.h"
 
 namespace bustub {
 
@@ -24,12 +34,16 @@ class DiskManagerTest : public ::testing::Test {
   void SetUp() override {
     remove("test.db");
     remove("test.log");
+    remove("test.fsm");
+    remove("test.cmap");
   }
 
   // This function is called after every test.
   void TearDown() override {
     remove("test.db");
     remove("test.log");
+    remove("test.fsm");
+    remove("test.cmap");
   };
 };
 
@@ -72,6 +86,384 @@ TEST_F(DiskManagerTest, ReadWriteLogTest) {
   dm.ShutDown();
 }
 
+// NOLINTNEXTLINE
+TEST_F(DiskManagerTest, AllocatePageTest) {
+  char data[BUSTUB_PAGE_SIZE] = {0};
+  std::string db_file("test.db");
+  {
+    auto dm = DiskManager(db_file);
+    for (page_id_t page_id = 0; page_id < 100; page_id++) {
+      EXPECT_EQ(page_id, dm.AllocatePage());
+    }
+    EXPECT_EQ(100, dm.GetNumPages());
+
+    // Scenario: freed pages are reused, the lowest one first, and the file does not grow.
+    dm.DeallocatePage(70);
+    dm.DeallocatePage(10);
+    dm.DeallocatePage(11);
+    dm.DeallocatePage(10);  // already free, no effect
+    EXPECT_FALSE(dm.IsPageAllocated(10));
+    EXPECT_TRUE(dm.IsPageAllocated(12));
+    EXPECT_EQ(10, dm.AllocatePage());
+    // the page after the last allocated one is free, so consecutive allocations stay adjacent
+    EXPECT_EQ(11, dm.AllocatePage());
+    EXPECT_EQ(70, dm.AllocatePage());
+    EXPECT_EQ(100, dm.AllocatePage());
+    EXPECT_EQ(101, dm.GetNumPages());
+
+    dm.DeallocatePage(3);
+    dm.WritePage(100, data);
+    dm.ShutDown();
+  }
+
+  // Scenario: the allocation map survives a restart.
+  {
+    auto dm = DiskManager(db_file);
+    EXPECT_EQ(101, dm.GetNumPages());
+    EXPECT_FALSE(dm.IsPageAllocated(3));
+    EXPECT_TRUE(dm.IsPageAllocated(100));
+    EXPECT_EQ(3, dm.AllocatePage());
+    EXPECT_EQ(101, dm.AllocatePage());
+    dm.ShutDown();
+  }
+
+  // Scenario: a database file without an allocation map has all of its pages allocated.
+  remove("test.fsm");
+  {
+    auto dm = DiskManager(db_file);
+    EXPECT_EQ(101, dm.GetNumPages());
+    EXPECT_TRUE(dm.IsPageAllocated(3));
+    EXPECT_EQ(101, dm.AllocatePage());
+    dm.ShutDown();
+  }
+}
+
+// NOLINTNEXTLINE
+TEST_F(DiskManagerTest, ExtentAllocationTest) {
+  auto dm = DiskManager("test.db");
+  EXPECT_EQ(0, dm.AllocatePage());
+
+  // Scenario: two segments growing at the same time do not interleave, each fills its own extents.
+  page_id_t table = dm.AllocatePage(NEW_SEGMENT);
+  page_id_t index = dm.AllocatePage(NEW_SEGMENT);
+  EXPECT_EQ(EXTENT_SIZE, table);
+  EXPECT_EQ(2 * EXTENT_SIZE, index);
+  for (int i = 1; i < EXTENT_SIZE + 10; i++) {
+    page_id_t table_page = dm.AllocatePage(table);
+    page_id_t index_page = dm.AllocatePage(index);
+    if (i < EXTENT_SIZE) {
+      EXPECT_EQ(table + i, table_page);
+      EXPECT_EQ(index + i, index_page);
+    } else {
+      // the next extents follow the ones in use
+      EXPECT_EQ(3 * EXTENT_SIZE + i - EXTENT_SIZE, table_page);
+      EXPECT_EQ(4 * EXTENT_SIZE + i - EXTENT_SIZE, index_page);
+    }
+  }
+
+  // Scenario: pages outside of segments skip the extents of segments.
+  EXPECT_EQ(1, dm.AllocatePage());
+  for (int i = 2; i < EXTENT_SIZE; i++) {
+    EXPECT_EQ(i, dm.AllocatePage());
+  }
+  EXPECT_EQ(5 * EXTENT_SIZE, dm.AllocatePage());
+
+  // Scenario: a segment fills its current extent, then reuses the free pages of its other extents.
+  dm.DeallocatePage(table + 5);
+  for (int i = 10; i < EXTENT_SIZE; i++) {
+    EXPECT_EQ(3 * EXTENT_SIZE + i, dm.AllocatePage(table));
+  }
+  EXPECT_EQ(table + 5, dm.AllocatePage(table));
+
+  // Scenario: an empty extent returns to the shared pool.
+  for (int i = 0; i < 10; i++) {
+    dm.DeallocatePage(4 * EXTENT_SIZE + i);
+  }
+  EXPECT_EQ(4 * EXTENT_SIZE, dm.AllocatePage());
+  // the segment claims a new extent after its full ones
+  EXPECT_EQ(6 * EXTENT_SIZE, dm.AllocatePage(index));
+  dm.ShutDown();
+}
+
+// NOLINTNEXTLINE
+TEST_F(DiskManagerTest, PageSizeTest) {
+  const size_t page_size = 4 * BUSTUB_PAGE_SIZE;
+  std::vector<char> buf(page_size, 0);
+  std::vector<char> data(page_size, 0);
+  std::strncpy(data.data(), "A test string.", page_size);
+  std::strncpy(data.data() + page_size - 8, "tail", 8);
+
+  EXPECT_THROW(DiskManager("test.db", 3 * BUSTUB_PAGE_SIZE), Exception);
+  EXPECT_THROW(DiskManager("test.db", 2 * BUSTUB_MAX_PAGE_SIZE), Exception);
+
+  {
+    auto dm = DiskManager("test.db", page_size);
+    EXPECT_EQ(page_size, dm.GetPageSize());
+    dm.WritePage(0, data.data());
+    dm.WritePage(3, data.data());
+    dm.ShutDown();
+  }
+
+  // Scenario: the page size recorded in the file wins over the requested one.
+  {
+    auto dm = DiskManager("test.db");
+    EXPECT_EQ(page_size, dm.GetPageSize());
+    EXPECT_EQ(4, dm.GetNumPages());
+    dm.ReadPage(3, buf.data());
+    EXPECT_EQ(std::memcmp(buf.data(), data.data(), page_size), 0);
+    dm.ShutDown();
+  }
+
+  // Scenario: a file that is not a database file is rejected.
+  remove("test.fsm");
+  {
+    std::ofstream file("test.db", std::ios::binary | std::ios::trunc);
+    file << "not a database";
+  }
+  EXPECT_THROW(DiskManager("test.db"), Exception);
+}
+
+// NOLINTNEXTLINE
+TEST_F(DiskManagerTest, LegacyFileTest) {
+  std::vector<char> buf(BUSTUB_PAGE_SIZE, 0);
+  {
+    // a db file written before the header existed: pages from offset 0
+    std::ofstream file("test.db", std::ios::binary | std::ios::trunc);
+    file << std::string(BUSTUB_PAGE_SIZE, 'a') << std::string(BUSTUB_PAGE_SIZE, 'b');
+  }
+
+  // Scenario: the pages of a legacy file are read where they are, new pages follow them, no header is added.
+  {
+    auto dm = DiskManager("test.db", 2 * BUSTUB_PAGE_SIZE);
+    EXPECT_EQ(BUSTUB_PAGE_SIZE, dm.GetPageSize());
+    EXPECT_EQ(2, dm.GetNumPages());
+    dm.ReadPage(1, buf.data());
+    EXPECT_EQ(std::string(BUSTUB_PAGE_SIZE, 'b'), std::string(buf.data(), BUSTUB_PAGE_SIZE));
+    EXPECT_EQ(2, dm.AllocatePage());
+    std::memset(buf.data(), 'c', BUSTUB_PAGE_SIZE);
+    dm.WritePage(2, buf.data());
+    dm.ShutDown();
+  }
+  {
+    std::ifstream file("test.db", std::ios::binary);
+    std::string content((std::istreambuf_iterator<char>(file)), std::istreambuf_iterator<char>());
+    EXPECT_EQ(std::string(BUSTUB_PAGE_SIZE, 'a') + std::string(BUSTUB_PAGE_SIZE, 'b') +
+                  std::string(BUSTUB_PAGE_SIZE, 'c'),
+              content);
+  }
+  auto dm = DiskManager("test.db");
+  dm.ReadPage(2, buf.data());
+  EXPECT_EQ(std::string(BUSTUB_PAGE_SIZE, 'c'), std::string(buf.data(), BUSTUB_PAGE_SIZE));
+  dm.ShutDown();
+
+  // Scenario: a compressed disk manager does not take a legacy file.
+  EXPECT_THROW(DiskManagerCompressed("test.db"), Exception);
+}
+
+// NOLINTNEXTLINE
+TEST_F(DiskManagerTest, ConcurrentReadWriteTest) {
+  const int num_threads = 8;
+  const int pages_per_thread = 64;
+  for (bool direct_io : {false, true}) {
+    auto dm = DiskManager("test.db", BUSTUB_PAGE_SIZE, direct_io);
+    // Scenario: unaligned buffers work with O_DIRECT too, reads past the end of the file see zeroes.
+    std::vector<char> buf(BUSTUB_PAGE_SIZE + 1, 'x');
+    dm.ReadPage(num_threads * pages_per_thread, buf.data() + 1);
+    EXPECT_EQ(std::string(BUSTUB_PAGE_SIZE, '\0'), std::string(buf.data() + 1, BUSTUB_PAGE_SIZE));
+
+    std::vector<std::thread> threads;
+    for (int tid = 0; tid < num_threads; tid++) {
+      threads.emplace_back([&dm, tid]() {
+        std::vector<char> data(BUSTUB_PAGE_SIZE + 1);
+        std::vector<char> read(BUSTUB_PAGE_SIZE + 1);
+        for (int i = 0; i < pages_per_thread; i++) {
+          page_id_t page_id = tid * pages_per_thread + i;
+          std::fill(data.begin(), data.end(), static_cast<char>(page_id));
+          if (i % 2 == 0) {
+            dm.WritePage(page_id, data.data() + 1);
+          } else {
+            dm.WritePages(page_id, {data.data()});
+          }
+          dm.ReadPage(page_id, read.data());
+          EXPECT_EQ(std::string(BUSTUB_PAGE_SIZE, static_cast<char>(page_id)),
+                    std::string(read.data(), BUSTUB_PAGE_SIZE));
+        }
+      });
+    }
+    for (auto &thread : threads) {
+      thread.join();
+    }
+    dm.ShutDown();
+    remove("test.db");
+    remove("test.fsm");
+  }
+}
+
+// NOLINTNEXTLINE
+TEST_F(DiskManagerTest, IoUringTest) {
+  const int num_pages = 20;
+  for (bool direct_io : {false, true}) {
+    // a queue depth of 4 splits the batches into several submissions
+    auto dm = DiskManagerUring("test.db", BUSTUB_PAGE_SIZE, direct_io, 4);
+    std::unique_ptr<char, decltype(&free)> frames(
+        static_cast<char *>(aligned_alloc(DiskManager::DIRECT_IO_ALIGNMENT, (num_pages + 2) * BUSTUB_PAGE_SIZE)), &free);
+    auto frame = [&](int i) { return frames.get() + i * BUSTUB_PAGE_SIZE; };
+    std::vector<DiskManager::PageIo> ios;
+    for (int i = 0; i < num_pages; i++) {
+      memset(frame(i), 'a' + i, BUSTUB_PAGE_SIZE);
+      ios.push_back({true, i, frame(i)});
+    }
+    // Scenario: requests on the same page keep their order, the second write of page 0 wins and the read sees it.
+    memset(frame(num_pages), 'z', BUSTUB_PAGE_SIZE);
+    ios.push_back({true, 0, frame(num_pages)});
+    ios.push_back({false, 0, frame(num_pages + 1)});
+    dm.ReadWritePages(ios);
+    EXPECT_EQ(std::string(BUSTUB_PAGE_SIZE, 'z'), std::string(frame(num_pages + 1), BUSTUB_PAGE_SIZE));
+
+    // Scenario: a batch of reads, with an unaligned buffer and a read past the end of the file.
+    std::vector<char> unaligned(BUSTUB_PAGE_SIZE + 1);
+    memset(frames.get(), 0, (num_pages + 2) * BUSTUB_PAGE_SIZE);
+    ios.clear();
+    for (int i = 1; i < num_pages; i++) {
+      ios.push_back({false, i, frame(i)});
+    }
+    ios.push_back({false, 0, unaligned.data() + 1});
+    memset(frame(num_pages), 'x', BUSTUB_PAGE_SIZE);
+    ios.push_back({false, num_pages, frame(num_pages)});
+    dm.ReadWritePages(ios);
+    for (int i = 1; i < num_pages; i++) {
+      EXPECT_EQ(std::string(BUSTUB_PAGE_SIZE, 'a' + i), std::string(frame(i), BUSTUB_PAGE_SIZE));
+    }
+    EXPECT_EQ(std::string(BUSTUB_PAGE_SIZE, 'z'), std::string(unaligned.data() + 1, BUSTUB_PAGE_SIZE));
+    EXPECT_EQ(std::string(BUSTUB_PAGE_SIZE, '\0'), std::string(frame(num_pages), BUSTUB_PAGE_SIZE));
+    EXPECT_EQ(num_pages + 1, dm.GetNumWrites());
+    dm.ShutDown();
+
+    // the pages are in the file for the plain disk manager
+    auto plain = DiskManager("test.db");
+    plain.ReadPage(num_pages - 1, unaligned.data());
+    EXPECT_EQ(std::string(BUSTUB_PAGE_SIZE, 'a' + num_pages - 1), std::string(unaligned.data(), BUSTUB_PAGE_SIZE));
+    plain.ShutDown();
+    remove("test.db");
+    remove("test.fsm");
+  }
+}
+
+// NOLINTNEXTLINE
+TEST_F(DiskManagerTest, DiskModelTest) {
+  using Clock = std::chrono::steady_clock;
+  auto dm = DiskManagerUnlimitedMemory();
+  std::vector<char> data(BUSTUB_PAGE_SIZE * 8, 'a');
+  std::vector<DiskManager::PageIo> ios;
+  for (int i = 0; i < 8; i++) {
+    ios.push_back({true, i * 2, data.data() + i * BUSTUB_PAGE_SIZE});
+  }
+  auto elapsed_us = [&](auto &&io) {
+    auto start = Clock::now();
+    io();
+    return std::chrono::duration_cast<std::chrono::microseconds>(Clock::now() - start).count();
+  };
+
+  // Scenario: a queue depth of 1 serves the random I/Os of a batch one after the other.
+  dm.SetDiskModel({2000, 0, 0, 1});
+  EXPECT_GE(elapsed_us([&] { dm.ReadWritePages(ios); }), 8 * 2000);
+
+  // Scenario: a deeper queue serves them together.
+  dm.SetDiskModel({20000, 0, 0, 8});
+  EXPECT_LT(elapsed_us([&] { dm.ReadWritePages(ios); }), 8 * 20000);
+
+  // Scenario: sequential I/Os skip the access latency, but not the transfer: 16 pages at 4 MiB/s take ~16ms.
+  dm.SetDiskModel({200000, 0, 4, 1});
+  dm.ReadPage(0, data.data());
+  auto us = elapsed_us([&] {
+    for (int i = 1; i <= 16; i++) {
+      dm.ReadPage(i, data.data());
+    }
+  });
+  EXPECT_GE(us, 16 * BUSTUB_PAGE_SIZE * 1000000L / (4 * 1024 * 1024));
+  EXPECT_LT(us, 200000);
+
+  dm.SetDiskModel(DiskModel::None());
+  EXPECT_THROW(DiskModel::FromName("floppy"), Exception);
+  EXPECT_EQ(DiskModel::Hdd().queue_depth_, DiskModel::FromName("hdd").queue_depth_);
+}
+
+// NOLINTNEXTLINE
+TEST_F(DiskManagerTest, CompressedTest) {
+  const int num_pages = 32;
+  auto text_page = [](int page_id) {
+    std::string page;
+    for (int i = 0; page.size() < BUSTUB_PAGE_SIZE; i++) {
+      page += "page " + std::to_string(page_id) + " tuple " + std::to_string(i) + " | ";
+    }
+    page.resize(BUSTUB_PAGE_SIZE);
+    return page;
+  };
+  std::string random_page(BUSTUB_PAGE_SIZE, '\0');
+  for (size_t i = 0; i < random_page.size(); i++) {
+    random_page[i] = static_cast<char>(i * 2654435761U >> 13);
+  }
+  std::vector<char> buf(BUSTUB_PAGE_SIZE);
+  auto read = [&](DiskManager &dm, page_id_t page_id) {
+    dm.ReadPage(page_id, buf.data());
+    return std::string(buf.data(), BUSTUB_PAGE_SIZE);
+  };
+
+  {
+    auto dm = DiskManagerCompressed("test.db");
+    EXPECT_EQ(std::string(BUSTUB_PAGE_SIZE, '\0'), read(dm, 0));  // tolerate empty read
+    for (int i = 0; i < num_pages; i++) {
+      dm.AllocatePage();
+      dm.WritePage(i, text_page(i).data());
+    }
+    // Scenario: text-like pages take a fraction of their size on disk.
+    EXPECT_LT(dm.GetStoredSize(), num_pages * BUSTUB_PAGE_SIZE / 2);
+    for (int i = 0; i < num_pages; i++) {
+      EXPECT_EQ(text_page(i), read(dm, i));
+    }
+
+    // Scenario: a page which grows moves to other slots without overwriting its neighbours, one which does not
+    // compress is stored as it is.
+    size_t stored = dm.GetStoredSize();
+    dm.WritePage(3, random_page.data());
+    EXPECT_EQ(random_page, read(dm, 3));
+    EXPECT_EQ(text_page(4), read(dm, 4));
+    EXPECT_GT(dm.GetStoredSize(), stored);
+
+    // Scenario: the freed slots are reused.
+    dm.WritePage(3, std::string(BUSTUB_PAGE_SIZE, 'x').data());
+    dm.DeallocatePage(5);
+    dm.WritePage(num_pages, text_page(num_pages).data());
+    EXPECT_LT(dm.GetStoredSize(), stored);
+    dm.ShutDown();
+  }
+
+  // Scenario: the pages survive a restart, a plain disk manager refuses the compressed file.
+  EXPECT_THROW(DiskManager("test.db"), Exception);
+  auto dm = DiskManagerCompressed("test.db");
+  EXPECT_EQ(std::string(BUSTUB_PAGE_SIZE, 'x'), read(dm, 3));
+  EXPECT_EQ(std::string(BUSTUB_PAGE_SIZE, '\0'), read(dm, 5));
+  for (int i = 0; i <= num_pages; i++) {
+    if (i != 3 && i != 5) {
+      EXPECT_EQ(text_page(i), read(dm, i));
+    }
+  }
+
+  // Scenario: the file shrinks back to its header once every page is deallocated.
+  for (int i = 0; i <= num_pages; i++) {
+    dm.DeallocatePage(i);
+  }
+  EXPECT_EQ(0, dm.GetStoredSize());
+  EXPECT_EQ(DiskManager::DB_FILE_HEADER_SIZE, std::ifstream("test.db", std::ios::binary | std::ios::ate).tellg());
+  dm.WritePage(0, text_page(0).data());
+  EXPECT_EQ(text_page(0), read(dm, 0));
+  dm.ShutDown();
+  remove("test.db");
+  auto plain = DiskManager("test.db");
+  plain.ShutDown();
+  EXPECT_THROW(DiskManagerCompressed("test.db"), Exception);
+}
+
 // NOLINTNEXTLINE
 TEST_F(DiskManagerTest, ThrowBadFileTest) { EXPECT_THROW(DiskManager("dev/null\\/foo/bar/baz/test.db"), Exception); }
 
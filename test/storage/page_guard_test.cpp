@@ -10,9 +10,12 @@
 //
 //===----------------------------------------------------------------------===//
 
+#include <atomic>
+#include <chrono>  // NOLINT
 #include <cstdio>
 #include <random>
 #include <string>
+#include <thread>  // NOLINT
 
 #include "buffer/buffer_pool_manager.h"
 #include "storage/disk/disk_manager_memory.h"
@@ -66,4 +69,93 @@ TEST(PageGuardTest, SampleTest) {
   disk_manager->ShutDown();
 }
 
+// NOLINTNEXTLINE
+TEST(PageGuardTest, OptimisticTest) {
+  const size_t buffer_pool_size = 2;
+  const size_t k = 2;
+
+  auto disk_manager = std::make_shared<DiskManagerUnlimitedMemory>();
+  auto bpm = std::make_shared<BufferPoolManager>(buffer_pool_size, disk_manager.get(), k);
+
+  page_id_t page_id;
+  auto *page = bpm->NewPage(&page_id);
+  snprintf(page->GetData(), BUSTUB_PAGE_SIZE, "hello");
+  bpm->UnpinPage(page_id, true);
+
+  // Scenario: an optimistic read takes no pin and stays valid while nobody writes the page.
+  auto guard = bpm->FetchPageOptimistic(page_id);
+  ASSERT_TRUE(guard.IsValid());
+  EXPECT_EQ(0, page->GetPinCount());
+  EXPECT_STREQ("hello", guard.GetData());
+  EXPECT_TRUE(guard.Validate());
+  { auto read_guard = bpm->FetchPageRead(page_id); }
+  EXPECT_TRUE(guard.Validate());
+
+  // Scenario: a write latch on the page invalidates it, even if nothing was changed.
+  {
+    auto write_guard = bpm->FetchPageWrite(page_id);
+    EXPECT_FALSE(guard.Validate());
+    EXPECT_FALSE(bpm->FetchPageOptimistic(page_id).IsValid());
+  }
+  EXPECT_FALSE(guard.Validate());
+  guard = bpm->FetchPageOptimistic(page_id);
+  EXPECT_TRUE(guard.Validate());
+
+  // Scenario: giving the frame to another page invalidates it, and a page that is not resident cannot be read
+  // optimistically.
+  ASSERT_TRUE(bpm->DeletePage(page_id));
+  EXPECT_FALSE(guard.Validate());
+  EXPECT_FALSE(bpm->FetchPageOptimistic(page_id).IsValid());
+
+  disk_manager->ShutDown();
+}
+
+// NOLINTNEXTLINE
+TEST(PageGuardTest, UpgradeTest) {
+  const size_t buffer_pool_size = 2;
+  const size_t k = 2;
+
+  auto disk_manager = std::make_shared<DiskManagerUnlimitedMemory>();
+  auto bpm = std::make_shared<BufferPoolManager>(buffer_pool_size, disk_manager.get(), k);
+
+  page_id_t page_id;
+  auto *page = bpm->NewPage(&page_id);
+  bpm->UnpinPage(page_id, false);
+
+  // Scenario: an upgradable guard lets readers in but keeps writers out until it is dropped.
+  auto guard = bpm->FetchPageUpgradable(page_id);
+  EXPECT_EQ(1, page->GetPinCount());
+  std::thread([&] { EXPECT_EQ(page_id, bpm->FetchPageRead(page_id).PageId()); }).join();
+  std::atomic<bool> written = false;
+  std::thread writer([&] {
+    auto write_guard = bpm->FetchPageWrite(page_id);
+    snprintf(write_guard.GetDataMut(), BUSTUB_PAGE_SIZE, "writer");
+    written = true;
+  });
+  std::this_thread::sleep_for(std::chrono::milliseconds(50));
+  EXPECT_FALSE(written);
+
+  // Scenario: the upgrade happens before the waiting writer gets the page.
+  auto optimistic_guard = bpm->FetchPageOptimistic(page_id);
+  ASSERT_TRUE(optimistic_guard.IsValid());
+  {
+    auto write_guard = guard.Upgrade();
+    EXPECT_EQ(std::string(""), std::string(write_guard.GetData()));
+    snprintf(write_guard.GetDataMut(), BUSTUB_PAGE_SIZE, "upgrader");
+    EXPECT_FALSE(optimistic_guard.Validate());
+  }
+  writer.join();
+  EXPECT_TRUE(written);
+  EXPECT_EQ(std::string("writer"), std::string(page->GetData()));
+  EXPECT_EQ(0, page->GetPinCount());
+
+  // Scenario: dropping the guard without upgrading releases the latch and the pin.
+  guard = bpm->FetchPageUpgradable(page_id);
+  guard.Drop();
+  EXPECT_EQ(0, page->GetPinCount());
+  bpm->FetchPageWrite(page_id).Drop();
+
+  disk_manager->ShutDown();
+}
+
 }  // namespace bustub
@@ -2,6 +2,7 @@
 #include <iostream>
 #include <memory>
 #include <mutex>  // NOLINT
+#include <optional>
 #include <random>
 #include <sstream>
 #include <string>
@@ -13,7 +14,7 @@
 #include "argparse/argparse.hpp"
 #include "binder/binder.h"
 #include "buffer/buffer_pool_manager.h"
-#include "buffer/lru_k_replacer.h"
+#include "buffer/replacer.h"
 #include "common/config.h"
 #include "common/exception.h"
 #include "common/util/string_util.h"
@@ -110,6 +111,15 @@ auto main(int argc, char **argv) -> int {
   argparse::ArgumentParser program("bustub-bpm-bench");
   program.add_argument("--duration").help("run bpm bench for n milliseconds");
   program.add_argument("--latency").help("set disk latency to n milliseconds");
+  program.add_argument("--disk").help("simulate a device: none, nvme, ssd or hdd, replaces --latency");
+  program.add_argument("--instances").help("split the buffer pool into n partitions");
+  program.add_argument("--replacer").help("replacement policy: lru, clock, lru-k, arc or 2q").default_value(
+      std::string("lru-k"));
+  program.add_argument("--page-size").help("size of the pages in bytes, a power of two from 4096 to 65536");
+  program.add_argument("--huge-pages")
+      .help("back the buffer pool with huge pages")
+      .default_value(false)
+      .implicit_value(true);
 
   try {
     program.parse_args(argc, argv);
@@ -129,12 +139,48 @@ auto main(int argc, char **argv) -> int {
     latency_ms = std::stoi(program.get("--latency"));
   }
 
-  auto disk_manager = std::make_unique<DiskManagerUnlimitedMemory>();
-  auto bpm = std::make_unique<BufferPoolManager>(BUSTUB_BPM_SIZE, disk_manager.get(), LRU_K_SIZE);
+  uint64_t bpm_instances = 1;
+  if (program.present("--instances")) {
+    bpm_instances = std::stoi(program.get("--instances"));
+  }
+
+  size_t page_size = bustub::BUSTUB_PAGE_SIZE;
+  if (program.present("--page-size")) {
+    page_size = std::stoi(program.get("--page-size"));
+  }
+
+  bustub::enable_huge_pages = program.get<bool>("--huge-pages");
+
+  bustub::ReplacerPolicy replacer_policy;
+  std::optional<bustub::DiskModel> disk_model;
+  try {
+    replacer_policy = bustub::ParseReplacerPolicy(program.get("--replacer"));
+    if (program.present("--disk")) {
+      disk_model = bustub::DiskModel::FromName(program.get("--disk"));
+    }
+  } catch (const bustub::Exception &err) {
+    std::cerr << err.what() << std::endl;
+    std::cerr << program;
+    return 1;
+  }
+
+  std::unique_ptr<DiskManagerUnlimitedMemory> disk_manager;
+  try {
+    disk_manager = std::make_unique<DiskManagerUnlimitedMemory>(page_size);
+  } catch (const bustub::Exception &err) {
+    std::cerr << err.what() << std::endl;
+    std::cerr << program;
+    return 1;
+  }
+  auto bpm = std::make_unique<BufferPoolManager>(BUSTUB_BPM_SIZE, disk_manager.get(), LRU_K_SIZE, nullptr,
+                                                 bpm_instances, replacer_policy);
   std::vector<page_id_t> page_ids;
 
-  fmt::print(stderr, "[info] total_page={}, duration_ms={}, latency_ms={}, lru_k_size={}, bpm_size={}\n",
-             BUSTUB_PAGE_CNT, duration_ms, latency_ms, LRU_K_SIZE, BUSTUB_BPM_SIZE);
+  fmt::print(stderr,
+             "[info] total_page={}, duration_ms={}, latency_ms={}, disk={}, replacer={}, lru_k_size={}, bpm_size={}, "
+             "bpm_instances={}, page_size={}, huge_pages={}\n",
+             BUSTUB_PAGE_CNT, duration_ms, latency_ms, program.present("--disk").value_or("none"), bustub::ReplacerPolicyToString(replacer_policy), LRU_K_SIZE,
+             BUSTUB_BPM_SIZE, bpm_instances, page_size, bustub::enable_huge_pages.load());
 
   for (size_t i = 0; i < BUSTUB_PAGE_CNT; i++) {
     page_id_t page_id;
@@ -150,7 +196,13 @@ auto main(int argc, char **argv) -> int {
   }
 
   // enable disk latency after creating all pages
-  disk_manager->SetLatency(latency_ms);
+  if (disk_model.has_value()) {
+    disk_manager->SetDiskModel(*disk_model);
+  } else {
+    disk_manager->SetLatency(latency_ms);
+  }
+  // only count the accesses of the benchmark
+  bpm->ResetStats();
 
   fmt::print(stderr, "[info] benchmark start\n");
 
@@ -227,6 +279,7 @@ auto main(int argc, char **argv) -> int {
   }
 
   total_metrics.Report();
+  fmt::print(stderr, "[info] buffer pool stats\n{}", bpm->GetStats().ToString());
 
   return 0;
 }
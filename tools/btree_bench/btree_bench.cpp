@@ -119,6 +119,7 @@ auto main(int argc, char **argv) -> int {
 
   argparse::ArgumentParser program("bustub-btree-bench");
   program.add_argument("--duration").help("run btree bench for n milliseconds");
+  program.add_argument("--disk").help("simulate a device: none, nvme, ssd or hdd").default_value(std::string("none"));
 
   try {
     program.parse_args(argc, argv);
@@ -133,11 +134,20 @@ auto main(int argc, char **argv) -> int {
     duration_ms = std::stoi(program.get("--duration"));
   }
 
+  bustub::DiskModel disk_model;
+  try {
+    disk_model = bustub::DiskModel::FromName(program.get("--disk"));
+  } catch (const bustub::Exception &err) {
+    std::cerr << err.what() << std::endl;
+    std::cerr << program;
+    return 1;
+  }
+
   auto disk_manager = std::make_unique<DiskManagerUnlimitedMemory>();
   auto bpm = std::make_unique<BufferPoolManager>(BUSTUB_BPM_SIZE, disk_manager.get(), LRU_K_SIZE);
 
-  fmt::print(stderr, "[info] total_keys={}, duration_ms={}, lru_k_size={}, bpm_size={}\n", TOTAL_KEYS, duration_ms,
-             LRU_K_SIZE, BUSTUB_BPM_SIZE);
+  fmt::print(stderr, "[info] total_keys={}, duration_ms={}, disk={}, lru_k_size={}, bpm_size={}\n", TOTAL_KEYS,
+             duration_ms, program.get("--disk"), LRU_K_SIZE, BUSTUB_BPM_SIZE);
 
   auto key_schema = bustub::ParseCreateStatement("a bigint");
   bustub::GenericComparator<8> comparator(key_schema.get());
@@ -157,6 +167,9 @@ auto main(int argc, char **argv) -> int {
     index.Insert(index_key, rid, nullptr);
   }
 
+  // simulate the device after building the index
+  disk_manager->SetDiskModel(disk_model);
+
   fmt::print(stderr, "[info] benchmark start\n");
 
   BTreeTotalMetrics total_metrics;